@@ -0,0 +1,69 @@
+#include <JuceHeader.h>
+#include <iostream>
+
+//
+// Times the software blend effect for every Effect::Blend mode and prints the throughput in megapixels per second.
+//
+// Usage: BlendBenchmark [width] [height] [iterations]
+//
+// The images are software images, so this measures the CPU renderer rather than Direct2D. The time includes
+// reading both 8-bit input images and writing the 8-bit output, just as when a blend is drawn into a component.
+//
+
+static juce::Image createTestImage(int width, int height, juce::Colour colour1, juce::Colour colour2)
+{
+    juce::Image image{ juce::Image::ARGB, width, height, true, juce::SoftwareImageType{} };
+
+    juce::Graphics g{ image };
+    g.setGradientFill(juce::ColourGradient{ colour1, 0.0f, 0.0f, colour2, (float)width, (float)height, false });
+    g.fillAll();
+
+    g.setColour(juce::Colours::transparentBlack);
+    g.fillEllipse(image.getBounds().toFloat().reduced((float)width * 0.25f, (float)height * 0.25f));
+
+    return image;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    auto width = argc > 1 ? juce::String{ argv[1] }.getIntValue() : 1024;
+    auto height = argc > 2 ? juce::String{ argv[2] }.getIntValue() : 1024;
+    auto iterations = argc > 3 ? juce::String{ argv[3] }.getIntValue() : 20;
+    if (width <= 0 || height <= 0 || iterations <= 0)
+    {
+        std::cout << "Usage: BlendBenchmark [width] [height] [iterations]" << std::endl;
+        return 1;
+    }
+
+    auto destination = createTestImage(width, height, juce::Colours::orange, juce::Colours::darkblue.withAlpha(0.5f));
+    auto source = createTestImage(width, height, juce::Colours::limegreen.withAlpha(0.75f), juce::Colours::magenta);
+    juce::Image output{ juce::Image::ARGB, width, height, true, juce::SoftwareImageType{} };
+
+    std::cout << "Blend " << width << "x" << height << ", best of " << iterations << " runs" << std::endl;
+
+    auto megapixels = (double)width * (double)height / 1.0e6;
+    for (int mode = mescal::Effect::Blend::multiply; mode <= mescal::Effect::Blend::division; ++mode)
+    {
+        auto name = mescal::Effect::Blend::create(mode)->getPropertyInfo(mescal::Effect::Blend::mode).enumeration[mode];
+
+        auto bestSeconds = std::numeric_limits<double>::max();
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            //
+            // A new effect has nothing cached, so every run renders the blend
+            //
+            auto blend = mescal::Effect::Blend::create(mode) << destination << source;
+
+            auto start = juce::Time::getHighResolutionTicks();
+            blend->applyEffect(output, {}, true);
+            auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            bestSeconds = juce::jmin(bestSeconds, seconds);
+        }
+
+        std::cout << name.paddedRight(' ', 16) << juce::String{ megapixels / bestSeconds, 1 }.paddedLeft(' ', 10) << " MP/s" << std::endl;
+    }
+
+    return 0;
+}
@@ -14,8 +14,11 @@ MescalLookAndFeel::MescalLookAndFeel()
 
 void MescalLookAndFeel::drawButtonBackground(juce::Graphics& g, juce::Button& button, const juce::Colour& backgroundColour, bool shouldDrawButtonAsHighlighted, bool shouldDrawButtonAsDown)
 {
-    juce::Image buttonImage{ juce::Image::ARGB, button.getWidth(), button.getHeight(), true };
-    juce::Image outputImage{ juce::Image::ARGB, button.getWidth(), button.getHeight(), true };
+    //
+    // Reuse the same pair of images for every button that's the same size instead of allocating new ones for each paint
+    //
+    auto buttonImage = getImage(0, button.getLocalBounds());
+    auto outputImage = getImage(1, button.getLocalBounds());
 
     auto r = buttonImage.getBounds().toFloat().reduced(0.0f);
 
@@ -23,6 +26,8 @@ void MescalLookAndFeel::drawButtonBackground(juce::Graphics& g, juce::Button& bu
 
     {
         juce::Graphics imageG{ buttonImage };
+        clear(imageG);
+
         auto topColor = juce::Colour{ 0xffb0b4bf };
         auto c1 = juce::Colour{ 0xffcdd0d7 };
         auto c2 = juce::Colour{ 0xffdee1e6 };
@@ -85,16 +90,17 @@ void MescalLookAndFeel::drawButtonBackground(juce::Graphics& g, juce::Button& bu
     }
 #endif
 
-    outputEffect->applyEffect(outputImage, {}, false);
+    outputEffect->applyEffect(outputImage, {}, true);
     g.drawImageAt(outputImage, 0, 0);
 }
 
 void MescalLookAndFeel::drawLabel(juce::Graphics& g, juce::Label& label)
 {
-    juce::Image sliderImage{ juce::Image::ARGB, label.getWidth(), label.getHeight(), true };
+    auto sliderImage = getImage(2, label.getLocalBounds());
 
     {
         juce::Graphics imageG{ sliderImage };
+        clear(imageG);
         label.findColour(juce::Label::backgroundColourId);
         imageG.fillRect(sliderImage.getBounds());
     }
@@ -107,8 +113,8 @@ void MescalLookAndFeel::drawLabel(juce::Graphics& g, juce::Label& label)
         juce::AffineTransform::translation(-innerShadowSize, -innerShadowSize),
         innerShadowSize);
 
-    juce::Image outputImage{ juce::Image::ARGB, label.getWidth(), label.getHeight(), true };
-    innerShadow.getEffect()->applyEffect(outputImage, {}, false);
+    auto outputImage = getImage(3, label.getLocalBounds());
+    innerShadow.getEffect()->applyEffect(outputImage, {}, true);
     g.drawImageAt(outputImage, 0, 0);
 
     if (!label.isBeingEdited())
@@ -142,14 +148,20 @@ mescal::Effect::Ptr MescalLookAndFeel::addShadow(juce::Image const& sourceImage,
     shadow->setPropertyValue(mescal::Effect::Shadow::blurStandardDeviation, shadowSize);
     shadow->setPropertyValue(mescal::Effect::Shadow::color, mescal::colourToVector4(shadowColor));
 
+    auto composite = new mescal::Effect{ mescal::Effect::Type::composite };
+    composite->setPropertyValue(mescal::Effect::Composite::mode, mescal::Effect::Composite::sourceOver);
+    composite->setInput(1, sourceImage);
+
+    if (transform.isIdentity())
+    {
+        composite->setInput(0, shadow);
+        return composite;
+    }
+
     auto shadowTransform = new mescal::Effect{ mescal::Effect::Type::affineTransform2D };
     shadowTransform->setInput(0, shadow);
     shadowTransform->setPropertyValue(mescal::Effect::AffineTransform2D::transformMatrix, transform);
-
-    auto composite = new mescal::Effect{ mescal::Effect::Type::composite };
-    composite->setPropertyValue(mescal::Effect::Composite::mode, mescal::Effect::Composite::sourceOver);
     composite->setInput(0, shadowTransform);
-    composite->setInput(1, sourceImage);
 
     return composite;
 }
@@ -180,14 +192,11 @@ mescal::Effect::Ptr MescalLookAndFeel::create3DInnerShadow(juce::Image const& so
 
 juce::Image MescalLookAndFeel::getImage(int index, juce::Rectangle<int> size)
 {
-    if (images.size() < index + 1)
-    {
-        images.emplace_back(juce::Image::ARGB, size.getWidth(), size.getHeight(), true);
-        return images.back();
-    }
+    if (images.size() < (size_t)index + 1)
+        images.resize((size_t)index + 1);
 
-    auto& image = images[index];
-    if (image.getWidth() != size.getWidth() || image.getHeight() != size.getHeight())
+    auto& image = images[(size_t)index];
+    if (!image.isValid() || image.getWidth() != size.getWidth() || image.getHeight() != size.getHeight())
     {
         image = juce::Image{ juce::Image::ARGB, size.getWidth(), size.getHeight(), true };
     }
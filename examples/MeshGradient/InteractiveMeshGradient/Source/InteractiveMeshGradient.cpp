@@ -12,7 +12,7 @@ InteractiveMeshGradient::InteractiveMeshGradient()
 	        ++placementIterator;
 	        c.onChange = [this](VertexComponent& vertexComponent)
 	            {
-	                if (auto patch = vertexComponent.patch.lock())
+	                if (auto patch = vertexComponent.patch)
 	                {
 	                    patch->setCornerPosition(vertexComponent.placement, vertexComponent.getBounds().toFloat().getCentre());
 	                    updatePatchComponents();
@@ -32,7 +32,7 @@ InteractiveMeshGradient::InteractiveMeshGradient()
             ++placementIterator;
             c.onChange = [this](InteriorControlComponent& interiorControlComponent)
                 {
-                    if (auto patch = interiorControlComponent.patch.lock())
+                    if (auto patch = interiorControlComponent.patch)
                     {
                         patch->setInteriorControlPointPosition(interiorControlComponent.placement, interiorControlComponent.getBounds().toFloat().getCentre());
                         updatePatchComponents();
@@ -57,7 +57,7 @@ InteractiveMeshGradient::InteractiveMeshGradient()
                 c.controlPointPlacement = bezierControlPointPlacement;
                 c.onChange = [this](BezierControlComponent& controlComponent)
                     {
-                        if (auto patch = controlComponent.patch.lock())
+                        if (auto patch = controlComponent.patch)
                         {
                             patch->setBezierControlPointPosition(controlComponent.edgePlacement, controlComponent.controlPointPlacement, controlComponent.getBounds().toFloat().getCentre());
                             updatePatchComponents();
@@ -76,8 +76,9 @@ InteractiveMeshGradient::InteractiveMeshGradient()
     rowCountSlider.setRange(juce::Range<double>{ 1.0, 20.0 }, 1.0);
     rowCountSlider.onValueChange = [this]()
         {
-            mesh = nullptr;
             selectPatch(nullptr);
+            patchComponents.clear();
+            mesh = nullptr;
             createMesh();
             createComponents();
             updatePatchComponents();
@@ -148,20 +149,20 @@ void InteractiveMeshGradient::createMesh()
 
         for (auto patch : mesh->getPatches())
         {
-            patch->setColor(mescal::MeshGradient::CornerPlacement::topLeft, juce::Colours::red);
-            patch->setColor(mescal::MeshGradient::CornerPlacement::bottomLeft, juce::Colours::blue);
-            patch->setColor(mescal::MeshGradient::CornerPlacement::bottomRight, juce::Colours::yellow);
-            patch->setColor(mescal::MeshGradient::CornerPlacement::topRight, juce::Colours::green);
+            patch.setColor(mescal::MeshGradient::CornerPlacement::topLeft, juce::Colours::red);
+            patch.setColor(mescal::MeshGradient::CornerPlacement::bottomLeft, juce::Colours::blue);
+            patch.setColor(mescal::MeshGradient::CornerPlacement::bottomRight, juce::Colours::yellow);
+            patch.setColor(mescal::MeshGradient::CornerPlacement::topRight, juce::Colours::green);
 
             for (auto edgePlacement : mescal::MeshGradient::edgePlacements)
             {
-                auto edge = patch->getEdge(edgePlacement);
+                auto edge = patch.getEdge(edgePlacement);
 
                 juce::Line<float> line{ edge.tail, edge.head };
                 auto angle = line.getAngle();
                 edge.bezierControlPoints.first = line.getPointAlongLineProportionally(0.33f).getPointOnCircumference(20.0f, angle + juce::MathConstants<float>::halfPi);
                 edge.bezierControlPoints.second = line.getPointAlongLineProportionally(0.66f).getPointOnCircumference(20.0f, angle - juce::MathConstants<float>::halfPi);
-                patch->setEdge(edgePlacement, edge);
+                patch.setEdge(edgePlacement, edge);
             }
         }
     }
@@ -226,16 +227,19 @@ void InteractiveMeshGradient::selectPatch(PatchComponent* selectedPatchComponent
     for (auto& vertexComponent : vertexComponents)
     {
         vertexComponent.setVisible(false);
+        vertexComponent.patch.reset();
     }
 
     for (auto& bezierControlComponent : bezierControlComponents)
     {
         bezierControlComponent.setVisible(false);
+        bezierControlComponent.patch.reset();
     }
 
     for (auto& interiorControlComponent : interiorControlComponents)
     {
         interiorControlComponent.setVisible(false);
+        interiorControlComponent.patch.reset();
     }
 
     if (!selectedPatchComponent)
@@ -245,13 +249,13 @@ void InteractiveMeshGradient::selectPatch(PatchComponent* selectedPatchComponent
     selectedPatchComponent->selected = true;
 
     auto patch = selectedPatchComponent->patch;
-    
+
     {
         auto vertexComponentIterator = vertexComponents.begin();
         auto interiorControlComponentIterator = interiorControlComponents.begin();
         for (auto placement : mescal::MeshGradient::cornerPlacements)
         {
-            auto position = patch->getCornerPosition(placement);
+            auto position = patch.getCornerPosition(placement);
 
             (*vertexComponentIterator).patch = patch;
             (*vertexComponentIterator).setCentrePosition(position.roundToInt());
@@ -260,7 +264,7 @@ void InteractiveMeshGradient::selectPatch(PatchComponent* selectedPatchComponent
             vertexComponentIterator++;
 
             (*interiorControlComponentIterator).patch = patch;
-            (*interiorControlComponentIterator).setCentrePosition(patch->getInteriorControlPointPosition(placement)->roundToInt());
+            (*interiorControlComponentIterator).setCentrePosition(patch.getInteriorControlPointPosition(placement)->roundToInt());
             (*interiorControlComponentIterator).setVisible(true);
             (*interiorControlComponentIterator).toFront(true);
             interiorControlComponentIterator++;
@@ -271,7 +275,7 @@ void InteractiveMeshGradient::selectPatch(PatchComponent* selectedPatchComponent
         auto bezierControlComponentIterator = bezierControlComponents.begin();
         for (auto edgePlacement : mescal::MeshGradient::edgePlacements)
         {
-            auto edge = patch->getEdge(edgePlacement);
+            auto edge = patch.getEdge(edgePlacement);
 
             (*bezierControlComponentIterator).patch = patch;
             (*bezierControlComponentIterator).edgePlacement = edgePlacement;
@@ -325,7 +329,7 @@ void InteractiveMeshGradient::VertexComponent::paint(juce::Graphics& g)
     g.setColour(juce::Colours::black);
     g.drawEllipse(r, 2.0f);
 
-    if (auto p = patch.lock())
+    if (auto p = patch)
     {
         g.setColour(p->getColor(placement).toColour());
         g.fillEllipse(r.reduced(4.0f));
@@ -353,7 +357,7 @@ void InteractiveMeshGradient::BezierControlComponent::paint(juce::Graphics& g)
     g.drawEllipse(r, 2.0f);
 }
 
-InteractiveMeshGradient::PatchComponent::PatchComponent(std::shared_ptr<mescal::MeshGradient::Patch> patch_) :
+InteractiveMeshGradient::PatchComponent::PatchComponent(mescal::MeshGradient::Patch patch_) :
     patch(patch_)
 {
     setRepaintsOnMouseActivity(true);
@@ -421,25 +425,25 @@ void InteractiveMeshGradient::PatchComponent::updateOutlinePath()
 {
     path.clear();
 
-    path.startNewSubPath(patch->getCornerPosition(mescal::MeshGradient::CornerPlacement::topRight));
+    path.startNewSubPath(patch.getCornerPosition(mescal::MeshGradient::CornerPlacement::topRight));
 
     {
-        auto edge = patch->getEdge(mescal::MeshGradient::EdgePlacement::top);
-        path.cubicTo(*edge.bezierControlPoints.first, *edge.bezierControlPoints.second, patch->getCornerPosition(mescal::MeshGradient::CornerPlacement::topLeft));
+        auto edge = patch.getEdge(mescal::MeshGradient::EdgePlacement::top);
+        path.cubicTo(*edge.bezierControlPoints.first, *edge.bezierControlPoints.second, patch.getCornerPosition(mescal::MeshGradient::CornerPlacement::topLeft));
     }
 
     {
-        auto edge = patch->getEdge(mescal::MeshGradient::EdgePlacement::left);
-        path.cubicTo(*edge.bezierControlPoints.first, *edge.bezierControlPoints.second, patch->getCornerPosition(mescal::MeshGradient::CornerPlacement::bottomLeft));
+        auto edge = patch.getEdge(mescal::MeshGradient::EdgePlacement::left);
+        path.cubicTo(*edge.bezierControlPoints.first, *edge.bezierControlPoints.second, patch.getCornerPosition(mescal::MeshGradient::CornerPlacement::bottomLeft));
     }
 
     {
-        auto edge = patch->getEdge(mescal::MeshGradient::EdgePlacement::bottom);
-        path.cubicTo(*edge.bezierControlPoints.first, *edge.bezierControlPoints.second, patch->getCornerPosition(mescal::MeshGradient::CornerPlacement::bottomRight));
+        auto edge = patch.getEdge(mescal::MeshGradient::EdgePlacement::bottom);
+        path.cubicTo(*edge.bezierControlPoints.first, *edge.bezierControlPoints.second, patch.getCornerPosition(mescal::MeshGradient::CornerPlacement::bottomRight));
     }
 
     {
-        auto edge = patch->getEdge(mescal::MeshGradient::EdgePlacement::right);
-        path.cubicTo(*edge.bezierControlPoints.first, *edge.bezierControlPoints.second, patch->getCornerPosition(mescal::MeshGradient::CornerPlacement::topRight));
+        auto edge = patch.getEdge(mescal::MeshGradient::EdgePlacement::right);
+        path.cubicTo(*edge.bezierControlPoints.first, *edge.bezierControlPoints.second, patch.getCornerPosition(mescal::MeshGradient::CornerPlacement::topRight));
     }
 }
@@ -18,7 +18,7 @@ private:
         void paint(juce::Graphics& g) override;
 
         juce::ComponentDragger dragger;
-        std::weak_ptr<mescal::MeshGradient::Patch> patch;
+        std::optional<mescal::MeshGradient::Patch> patch;
         mescal::MeshGradient::EdgePlacement edgePlacement = mescal::MeshGradient::EdgePlacement::unknown;
         mescal::MeshGradient::BezierControlPointPlacement controlPointPlacement = mescal::MeshGradient::BezierControlPointPlacement::first;
         std::function<void(BezierControlComponent&)> onChange;
@@ -31,7 +31,7 @@ private:
         void paint(juce::Graphics& g) override {}
 
         juce::ComponentDragger dragger;
-        std::weak_ptr<mescal::MeshGradient::Patch> patch;
+        std::optional<mescal::MeshGradient::Patch> patch;
         mescal::MeshGradient::CornerPlacement placement = mescal::MeshGradient::CornerPlacement::unknown;
         std::function<void(InteriorControlComponent&)> onChange;
     };
@@ -44,21 +44,21 @@ private:
         void paint(juce::Graphics& g) override;
 
         juce::ComponentDragger dragger;
-        std::weak_ptr<mescal::MeshGradient::Patch> patch;
+        std::optional<mescal::MeshGradient::Patch> patch;
         mescal::MeshGradient::CornerPlacement placement = mescal::MeshGradient::CornerPlacement::unknown;
         std::function<void(VertexComponent&)> onChange;
     };
 
     struct PatchComponent : public juce::Component
     {
-        PatchComponent(std::shared_ptr<mescal::MeshGradient::Patch> patch_);
+        PatchComponent(mescal::MeshGradient::Patch patch_);
         bool hitTest(int x, int y) override;
         void paint(juce::Graphics& g) override;
         void mouseUp(const juce::MouseEvent& e) override;
         void updateOutlinePath();
 
         juce::Path path;
-        std::shared_ptr<mescal::MeshGradient::Patch> patch;
+        mescal::MeshGradient::Patch patch;
         bool selected = false;
         std::function<void(PatchComponent*)> onSelect;
     };
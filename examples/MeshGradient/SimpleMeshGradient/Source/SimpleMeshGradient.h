@@ -15,9 +15,11 @@ public:
         //
         auto blue = (float)std::sin(phase) * 0.5f + 0.5f;
         auto patch = meshGradient->getPatch(0, 0);
-        for (auto& color : patch->colors)
+        for (auto placement : mescal::MeshGradient::cornerPlacements)
         {
+            auto color = patch.getColor(placement);
             color.blue = blue;
+            patch.setColor(placement, color);
         }
 
         meshGradient->draw(outputImage, {});
@@ -75,9 +77,9 @@ private:
         auto colorIterator = colors.begin();
         auto patch = meshGradient->getPatch(0, 0);
 
-        for (int i = 0; i < 4; ++i)
+        for (auto placement : mescal::MeshGradient::cornerPlacements)
         {
-            patch->colors[i] = mescal::Color128{ *colorIterator++ };
+            patch.setColor(placement, *colorIterator++);
         }
     }
 
@@ -2,17 +2,128 @@
 
 namespace mescal
 {
-    struct Effect::Pimpl
+    struct Effect::Pimpl : public juce::ImagePixelData::Listener
     {
         Pimpl(Type effectType_) :
-            effectType(effectType_)
+            effectType(effectType_),
+            description(getDescription(effectType_))
         {
+            inputs.resize((size_t)description.maxNumInputs);
+
+            for (auto const& property : description.properties)
+                properties.emplace_back(property.defaultValue);
+        }
+
+        ~Pimpl() override
+        {
+            for (auto const& input : inputs)
+                if (auto pixelData = getPixelData(input))
+                    pixelData->listeners.remove(this);
+        }
+
+        /**
+         * Connects one input. The effect listens to the pixel data of each image input so that painting into the
+         * image marks the effect as changed.
+         */
+        void setInput(size_t index, Effect::Input const& input)
+        {
+            auto previousPixelData = getPixelData(inputs[index]);
+            inputs[index] = input;
+
+            if (previousPixelData && std::none_of(inputs.begin(), inputs.end(), [&](auto const& other) { return getPixelData(other) == previousPixelData; }))
+                previousPixelData->listeners.remove(this);
+
+            if (auto pixelData = getPixelData(input))
+                pixelData->listeners.add(this);
+
+            version.fetch_add(1, std::memory_order_relaxed);
+            inputVersion.fetch_add(1, std::memory_order_relaxed);
         }
 
-        ~Pimpl()
+        static juce::ImagePixelData::Ptr getPixelData(Effect::Input const& input)
         {
+            if (auto image = std::get_if<juce::Image>(&input))
+                return image->getPixelData();
+
+            return {};
         }
 
+        void imageDataChanged(juce::ImagePixelData*) override
+        {
+            version.fetch_add(1, std::memory_order_relaxed);
+            inputVersion.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void imageDataBeingDeleted(juce::ImagePixelData*) override
+        {
+            //
+            // Nothing to do; the connected Image keeps its pixel data alive until the input is replaced
+            //
+        }
+
+        /**
+         * Platform-independent metadata for each effect type, matching the Direct2D built-in effects.
+         * The stored property values use the same types that Direct2D reports for each property.
+         */
+        struct PropertyDescription
+        {
+            juce::String name;
+            PropertyValue defaultValue;
+            std::optional<juce::Range<float>> range;
+            juce::StringArray enumeration;
+            bool softwareOnly = false; // no matching Direct2D property; the Direct2D renderer ignores it
+        };
+
+        struct Description
+        {
+            juce::String displayName;
+            int maxNumInputs = 1;
+            std::vector<PropertyDescription> properties;
+        };
+
+        static Description const& getDescription(Type type);
+
+        /**
+         * Converts a property value to the type used to store that property; for example, a juce::Colour
+         * becomes a Vector4 and an int becomes an Enumeration
+         */
+        PropertyValue normalizePropertyValue(int index, PropertyValue const& value) const
+        {
+            auto const& defaultValue = description.properties[(size_t)index].defaultValue;
+
+            if (value.index() == defaultValue.index())
+                return value;
+
+            if (std::holds_alternative<Enumeration>(defaultValue))
+            {
+                if (auto intValue = std::get_if<int>(&value))
+                    return (Enumeration)*intValue;
+                if (auto uintValue = std::get_if<uint32_t>(&value))
+                    return (Enumeration)*uintValue;
+            }
+            else if (std::holds_alternative<float>(defaultValue))
+            {
+                if (auto intValue = std::get_if<int>(&value))
+                    return (float)*intValue;
+            }
+            else if (std::holds_alternative<Vector4>(defaultValue))
+            {
+                if (auto colour = std::get_if<juce::Colour>(&value))
+                    return colourToVector4(*colour);
+                if (auto rect = std::get_if<juce::Rectangle<float>>(&value))
+                    return Vector4{ rect->getX(), rect->getY(), rect->getRight(), rect->getBottom() };
+            }
+            else if (std::holds_alternative<Vector3>(defaultValue))
+            {
+                if (auto colour = std::get_if<juce::Colour>(&value))
+                    return Vector3{ colour->getFloatRed(), colour->getFloatGreen(), colour->getFloatBlue() };
+            }
+
+            jassertfalse;
+            return value;
+        }
+
+#if JUCE_WINDOWS
         void createD2DEffect()
         {
             if (auto hr = resources->create(); FAILED(hr))
@@ -29,23 +140,6 @@ namespace mescal
                     jassertfalse;
                 }
             }
-
-            if (d2dEffect)
-            {
-                uint32_t maxNumInputs = 0;
-
-                if (auto hr = d2dEffect->GetValue(D2D1_PROPERTY_MAX_INPUTS, &maxNumInputs); FAILED(hr))
-                {
-                    maxNumInputs = 1;
-                }
-
-                //
-                // Some effects can accept MAX_INT inputs but only the first two seem to be usable
-                //
-                maxNumInputs = juce::jmin(2u, maxNumInputs);
-
-                inputs.resize(maxNumInputs);
-            }
         }
 
         static juce::String getName(ID2D1Properties* properties, int propertyIndex)
@@ -151,117 +245,10 @@ namespace mescal
         }
 #endif
 
-        int getNumProperties()
-        {
-            if (!d2dEffect)
-                createD2DEffect();
-
-            if (!d2dEffect)
-                return 0;
-
-            return d2dEffect->GetPropertyCount();
-        }
-
-        juce::String getPropertyName(int index)
-        {
-            WCHAR nameBuffer[256];
-
-            if (!d2dEffect)
-                createD2DEffect();
-
-            if (!d2dEffect)
-                return {};
-
-            if (auto hr = d2dEffect->GetPropertyName(index, nameBuffer, sizeof(nameBuffer) / sizeof(WCHAR)); FAILED(hr))
-            {
-                jassertfalse;
-                return {};
-            }
-
-            return juce::String{ nameBuffer };
-        }
-
-        PropertyInfo getPropertyInfo(int index)
-        {
-            PropertyInfo info;
-
-            info.name = getPropertyName(index);
-            auto type = d2dEffect->GetType(index);
-            switch (type)
-            {
-            case D2D1_PROPERTY_TYPE_FLOAT:
-            {
-                winrt::com_ptr<ID2D1Properties> subproperties;
-                if (auto hr = d2dEffect->GetSubProperties(index, subproperties.put()); SUCCEEDED(hr))
-                {
-                    float min = subproperties->GetValue<float>(D2D1_SUBPROPERTY_MIN);
-                    float max = subproperties->GetValue<float>(D2D1_SUBPROPERTY_MAX);
-                    info.range = juce::Range<float>{ min, max };
-                }
-                break;
-            }
-
-            case D2D1_PROPERTY_TYPE_ENUM:
-            case D2D1_PROPERTY_TYPE_VECTOR3:
-            case D2D1_PROPERTY_TYPE_VECTOR4:
-            {
-                winrt::com_ptr<ID2D1Properties> subproperties;
-                if (auto hr = d2dEffect->GetSubProperties(index, subproperties.put()); SUCCEEDED(hr))
-                {
-                    winrt::com_ptr<ID2D1Properties> subpropertyFields;
-                    if (hr = subproperties->GetSubProperties(D2D1_SUBPROPERTY_FIELDS, subpropertyFields.put()); SUCCEEDED(hr))
-                    {
-                        auto count = subpropertyFields->GetPropertyCount();
-                        for (uint32_t i = 0; i < count; ++i)
-                        {
-                            WCHAR nameBuffer[256];
-                            if (hr = subpropertyFields->GetPropertyName(i, nameBuffer, sizeof(nameBuffer) / sizeof(WCHAR)); SUCCEEDED(hr))
-                            {
-                                info.enumeration.add(juce::String{ nameBuffer });
-                            }
-                        }
-                    }
-                }
-                break;
-            }
-
-            default:
-                break;
-            }
-
-            return info;
-        }
-
-        template <typename T> T blockToValue(juce::MemoryBlock const& block)
-        {
-            return *reinterpret_cast<T const*>(block.getData());
-        };
-
-        template<> juce::String blockToValue<juce::String>(juce::MemoryBlock const& block)
-        {
-            return block.toString();
-        }
-
-        juce::AffineTransform matrixToAffineTransform(juce::MemoryBlock const& block)
-        {
-            auto matrix3x2 = (D2D1_MATRIX_3X2_F const* const)block.getData();
-            juce::AffineTransform transform;
-            transform.mat00 = matrix3x2->m11;
-            transform.mat01 = matrix3x2->m12;
-            transform.mat02 = matrix3x2->dx;
-            transform.mat10 = matrix3x2->m21;
-            transform.mat11 = matrix3x2->m22;
-            transform.mat12 = matrix3x2->dy;
-            return transform;
-        }
-
-        void setProperty(int index, const PropertyValue value)
+        void setD2DProperty(int index, const PropertyValue value)
         {
             [[maybe_unused]] HRESULT hr = S_OK;
 
-            if (!d2dEffect)
-                createD2DEffect();
-
             if (!d2dEffect)
                 return;
 
@@ -273,6 +260,10 @@ namespace mescal
             {
                 hr = d2dEffect->SetValue(index, std::get<int>(value));
             }
+            else if (std::holds_alternative<Enumeration>(value))
+            {
+                hr = d2dEffect->SetValue(index, (uint32_t)std::get<Enumeration>(value));
+            }
             else if (std::holds_alternative<float>(value))
             {
                 d2dEffect->SetValue(index, std::get<float>(value));
@@ -316,65 +307,6 @@ namespace mescal
             jassert(SUCCEEDED(hr));
         }
 
-        PropertyValue getProperty(int index)
-        {
-            if (!d2dEffect)
-                createD2DEffect();
-
-            if (!d2dEffect)
-                return {};
-
-            auto type = d2dEffect->GetType(index);
-            auto size = d2dEffect->GetValueSize(index);
-            juce::MemoryBlock valueBlock{ size };
-
-            if (auto hr = d2dEffect->GetValue(index, (uint8_t*)valueBlock.getData(), size); FAILED(hr))
-            {
-                jassertfalse;
-                return {};
-            }
-
-            PropertyValue value;
-            switch (type)
-            {
-            default:
-                jassertfalse;
-                break;
-
-            case D2D1_PROPERTY_TYPE_STRING:
-                return valueBlock.toString();
-
-            case D2D1_PROPERTY_TYPE_BOOL:
-                return blockToValue<bool>(valueBlock);
-
-            case D2D1_PROPERTY_TYPE_UINT32:
-                return blockToValue<uint32_t>(valueBlock);
-
-            case D2D1_PROPERTY_TYPE_INT32:
-                return blockToValue<int>(valueBlock);
-
-            case D2D1_PROPERTY_TYPE_FLOAT:
-                return blockToValue<float>(valueBlock);
-
-            case D2D1_PROPERTY_TYPE_VECTOR2:
-                return blockToValue<Vector2>(valueBlock);
-
-            case D2D1_PROPERTY_TYPE_VECTOR3:
-                return blockToValue<Vector3>(valueBlock);
-
-            case D2D1_PROPERTY_TYPE_VECTOR4:
-                return blockToValue<Vector4>(valueBlock);
-
-            case D2D1_PROPERTY_TYPE_ENUM:
-                return blockToValue<uint8_t>(valueBlock);
-
-            case D2D1_PROPERTY_TYPE_MATRIX_3X2:
-                return matrixToAffineTransform(valueBlock);
-            }
-
-            return {};
-        }
-
         static void setInputsRecursive(Pimpl* pimpl)
         {
             for (size_t index = 0; index < pimpl->inputs.size(); ++index)
@@ -382,17 +314,7 @@ namespace mescal
                 auto& input = pimpl->inputs[index];
                 if (std::holds_alternative<juce::Image>(input))
                 {
-                    auto image = std::get<juce::Image>(input);
-                    if (image.isValid())
-                    {
-                        if (juce::Direct2DPixelData::Ptr inputPixelData = dynamic_cast<juce::Direct2DPixelData*>(image.getPixelData().get()))
-                        {
-                            if (auto bitmap = inputPixelData->getFirstPageForDevice(pimpl->resources->adapter->direct2DDevice))
-                            {
-                                pimpl->d2dEffect->SetInput((uint32_t)index, bitmap);
-                            }
-                        }
-                    }
+                    setImageInput(pimpl, index);
                 }
                 else if (std::holds_alternative<Effect::Ptr>(input))
                 {
@@ -404,7 +326,80 @@ namespace mescal
             }
         }
 
-        Type effectType;
+        /**
+         * Connects the Direct2D bitmap for one image input of the effect
+         */
+        static void setImageInput(Pimpl* pimpl, size_t index)
+        {
+            auto image = std::get<juce::Image>(pimpl->inputs[index]);
+            if (image.isValid())
+            {
+                if (juce::Direct2DPixelData::Ptr inputPixelData = dynamic_cast<juce::Direct2DPixelData*>(image.getPixelData().get()))
+                {
+                    if (auto bitmap = inputPixelData->getFirstPageForDevice(pimpl->resources->adapter->direct2DDevice))
+                    {
+                        pimpl->d2dEffect->SetInput((uint32_t)index, bitmap);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Sets just the image inputs of this effect, leaving the connections to other effects as they are
+         */
+        void setImageInputs()
+        {
+            for (size_t index = 0; index < inputs.size(); ++index)
+            {
+                if (std::holds_alternative<juce::Image>(inputs[index]))
+                    setImageInput(this, index);
+            }
+        }
+
+        /**
+         * bindInputs can be false if every effect in the graph is already connected to its inputs, as it is for a
+         * Plan whose graph hasn't changed
+         */
+        bool drawDirect2D(juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination, juce::RectangleList<int> const& dirtyRegion,
+            bool bindInputs = true)
+        {
+            juce::Direct2DPixelData::Ptr outputPixelData = dynamic_cast<juce::Direct2DPixelData*>(outputImage.getPixelData().get());
+            if (!outputPixelData)
+                return false;
+
+            createD2DEffect();
+            if (!d2dEffect)
+                return false;
+
+            if (bindInputs)
+                setInputsRecursive(this);
+
+            resources->deviceContext->SetTarget(outputPixelData->getFirstPageForDevice(resources->adapter->direct2DDevice));
+            resources->deviceContext->BeginDraw();
+
+            //
+            // Direct2D limits the effect's region of interest to the clip, so each dirty rectangle only renders its own pixels
+            //
+            for (auto const& rectangle : dirtyRegion)
+            {
+                resources->deviceContext->SetTransform(D2D1::Matrix3x2F::Identity());
+                resources->deviceContext->PushAxisAlignedClip(juce::D2DUtilities::toRECT_F(rectangle), D2D1_ANTIALIAS_MODE_ALIASED);
+                if (clearDestination)
+                    resources->deviceContext->Clear();
+
+                if (!transform.isIdentity())
+                    resources->deviceContext->SetTransform(juce::D2DUtilities::transformToMatrix(transform));
+
+                resources->deviceContext->DrawImage(d2dEffect.get());
+                resources->deviceContext->PopAxisAlignedClip();
+            }
+
+            resources->deviceContext->SetTransform(D2D1::Matrix3x2F::Identity());
+            [[maybe_unused]] auto hr = resources->deviceContext->EndDraw();
+            jassert(SUCCEEDED(hr));
+
+            return true;
+        }
 
         struct Resources
         {
@@ -444,7 +439,6 @@ namespace mescal
         };
         juce::SharedResourcePointer<Resources> resources;
         winrt::com_ptr<ID2D1Effect> d2dEffect;
-        std::vector<Effect::Input> inputs;
 
         static constexpr std::array<GUID const* const, (size_t)Type::numEffectTypes> effectGuids
         {
@@ -467,13 +461,207 @@ namespace mescal
             &CLSID_D2D1SpotDiffuse,
             &CLSID_D2D1SpotSpecular
         };
+#endif
+
+        void drawSoftware(Effect& effect, juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination,
+            juce::RectangleList<int> const& dirtyRegion)
+        {
+            software::EffectRenderer renderer;
+            renderer.render(effect, outputImage, transform, clearDestination, dirtyRegion);
+        }
+
+        Type effectType;
+        Description const& description;
+        std::vector<Effect::Input> inputs;
+        std::vector<PropertyValue> properties;
+
+        //
+        // Image listener callbacks bump these on whichever thread paints into an input image
+        //
+        std::atomic<uint64_t> version = 1;
+        std::atomic<uint64_t> inputVersion = 1;
+        software::EffectCache softwareCache;
     };
 
+    Effect::Pimpl::Description const& Effect::Pimpl::getDescription(Type type)
+    {
+        static juce::StringArray const interpolationModes{ "NearestNeighbor", "Linear", "Cubic", "MultiSampleLinear", "Anisotropic", "HighQualityCubic" };
+        static juce::StringArray const borderModes{ "Soft", "Hard" };
+        static juce::StringArray const optimizationModes{ "Speed", "Balanced", "Quality" };
+        static constexpr float floatMax = std::numeric_limits<float>::max();
+
+        static std::array<Description, (size_t)Type::numEffectTypes> const descriptions
+        {
+            Description
+            {
+                "2D Affine Transform", 1,
+                {
+                    { "InterpolationMode", (Enumeration)AffineTransform2D::linear, {}, interpolationModes },
+                    { "BorderMode", (Enumeration)AffineTransform2D::soft, {}, borderModes },
+                    { "TransformMatrix", juce::AffineTransform{}, {}, {} },
+                    { "Sharpness", 1.0f, juce::Range<float>{ 0.0f, 1.0f }, {} }
+                }
+            },
+            Description{ "Alpha Mask", 2, {} },
+            Description
+            {
+                "Arithmetic Composite", 2,
+                {
+                    { "Coefficients", Vector4{ 1.0f, 0.0f, 0.0f, 0.0f }, {}, {} },
+                    { "ClampOutput", false, {}, {} }
+                }
+            },
+            Description
+            {
+                "Blend", 2,
+                {
+                    { "Mode", (Enumeration)Blend::multiply, {},
+                        { "Multiply", "Screen", "Darken", "Lighten", "Dissolve", "ColorBurn", "LinearBurn", "DarkerColor", "LighterColor",
+                        "ColorDodge", "LinearDodge", "Overlay", "SoftLight", "HardLight", "VividLight", "LinearLight", "PinLight", "HardMix",
+                        "Difference", "Exclusion", "Hue", "Saturation", "Color", "Luminosity", "Subtract", "Division" } }
+                }
+            },
+            Description
+            {
+                "Chroma Key", 1,
+                {
+                    { "Color", Vector3{ 0.0f, 0.0f, 0.0f }, {}, {} },
+                    { "Tolerance", 0.1f, juce::Range<float>{ 0.0f, 1.0f }, {} },
+                    { "InvertAlpha", false, {}, {} },
+                    { "Feather", false, {}, {} },
+                    { "DistanceMetric", (Enumeration)ChromaKey::rgb, {}, { "RGB", "YCbCr" }, true }
+                }
+            },
+            Description
+            {
+                "Composite", 2,
+                {
+                    { "Mode", (Enumeration)Composite::sourceOver, {},
+                        { "SourceOver", "DestinationOver", "SourceIn", "DestinationIn", "SourceOut", "DestinationOut", "SourceAtop",
+                        "DestinationAtop", "Xor", "Plus", "SourceCopy", "BoundedSourceCopy", "MaskInvert" } }
+                }
+            },
+            Description
+            {
+                "Crop", 1,
+                {
+                    { "Rect", Vector4{ -floatMax, -floatMax, floatMax, floatMax }, {}, {} },
+                    { "BorderMode", (Enumeration)Crop::soft, {}, borderModes }
+                }
+            },
+            Description
+            {
+                "Edge Detection", 1,
+                {
+                    { "Strength", 0.5f, juce::Range<float>{ 0.0f, 1.0f }, {} },
+                    { "BlurRadius", 0.0f, juce::Range<float>{ 0.0f, 10.0f }, {} },
+                    { "Mode", (Enumeration)0, {}, { "Sobel", "Prewitt" } },
+                    { "OverlayEdges", false, {}, {} }
+                }
+            },
+            Description
+            {
+                "Emboss", 1,
+                {
+                    { "Height", 1.0f, juce::Range<float>{ 0.0f, 10.0f }, {} },
+                    { "Direction", 0.0f, juce::Range<float>{ 0.0f, 360.0f }, {} }
+                }
+            },
+            Description
+            {
+                "Flood", 0,
+                {
+                    { "Color", Vector4{ 0.0f, 0.0f, 0.0f, 1.0f }, {}, {} }
+                }
+            },
+            Description
+            {
+                "Gaussian Blur", 1,
+                {
+                    { "StandardDeviation", 3.0f, juce::Range<float>{ 0.0f, 250.0f }, {} },
+                    { "Optimization", (Enumeration)GaussianBlur::balanced, {}, optimizationModes },
+                    { "BorderMode", (Enumeration)GaussianBlur::soft, {}, borderModes }
+                }
+            },
+            Description
+            {
+                "Highlights and Shadows", 1,
+                {
+                    { "Highlights", 0.0f, juce::Range<float>{ -1.0f, 1.0f }, {} },
+                    { "Shadows", 0.0f, juce::Range<float>{ -1.0f, 1.0f }, {} },
+                    { "Clarity", 0.0f, juce::Range<float>{ -1.0f, 1.0f }, {} },
+                    { "InputGamma", (Enumeration)HighlightsAndShadows::linear, {}, { "Linear", "SRGB" } },
+                    { "MaskBlurRadius", 1.25f, juce::Range<float>{ 0.0f, 10.0f }, {} }
+                }
+            },
+            Description{ "Invert", 1, {} },
+            Description{ "Luminance To Alpha", 1, {} },
+            Description
+            {
+                "3D Perspective Transform", 1,
+                {
+                    { "InterpolationMode", (Enumeration)PerspectiveTransform3D::linear, {}, interpolationModes },
+                    { "BorderMode", (Enumeration)PerspectiveTransform3D::soft, {}, borderModes },
+                    { "Depth", 1000.0f, {}, {} },
+                    { "PerspectiveOrigin", Vector2{ 0.0f, 0.0f }, {}, {} },
+                    { "LocalOffset", Vector3{ 0.0f, 0.0f, 0.0f }, {}, {} },
+                    { "GlobalOffset", Vector3{ 0.0f, 0.0f, 0.0f }, {}, {} },
+                    { "RotationOrigin", Vector3{ 0.0f, 0.0f, 0.0f }, {}, {} },
+                    { "Rotation", Vector3{ 0.0f, 0.0f, 0.0f }, {}, {} }
+                }
+            },
+            Description
+            {
+                "Shadow", 1,
+                {
+                    { "BlurStandardDeviation", 3.0f, juce::Range<float>{ 0.0f, 250.0f }, {} },
+                    { "Color", Vector4{ 0.0f, 0.0f, 0.0f, 1.0f }, {}, {} },
+                    { "Optimization", (Enumeration)Shadow::balanced, {}, optimizationModes }
+                }
+            },
+            Description
+            {
+                "Spot Diffuse Lighting", 1,
+                {
+                    { "LightPosition", Vector3{ 0.0f, 0.0f, 0.0f }, {}, {} },
+                    { "PointsAt", Vector3{ 0.0f, 0.0f, 0.0f }, {}, {} },
+                    { "Focus", 1.0f, juce::Range<float>{ 0.0f, 200.0f }, {} },
+                    { "LimitingConeAngle", 90.0f, juce::Range<float>{ -90.0f, 90.0f }, {} },
+                    { "DiffuseConstant", 1.0f, juce::Range<float>{ 0.0f, 10000.0f }, {} },
+                    { "SurfaceScale", 1.0f, juce::Range<float>{ 0.0f, 10000.0f }, {} },
+                    { "Color", Vector3{ 1.0f, 1.0f, 1.0f }, {}, {} },
+                    { "KernelUnitLength", Vector2{ 1.0f, 1.0f }, {}, {} },
+                    { "ScaleMode", (Enumeration)SpotDiffuseLighting::linear, {}, interpolationModes }
+                }
+            },
+            Description
+            {
+                "Spot Specular Lighting", 1,
+                {
+                    { "LightPosition", Vector3{ 0.0f, 0.0f, 0.0f }, {}, {} },
+                    { "PointsAt", Vector3{ 0.0f, 0.0f, 0.0f }, {}, {} },
+                    { "Focus", 1.0f, juce::Range<float>{ 0.0f, 200.0f }, {} },
+                    { "LimitingConeAngle", 90.0f, juce::Range<float>{ -90.0f, 90.0f }, {} },
+                    { "SpecularExponent", 1.0f, juce::Range<float>{ 1.0f, 128.0f }, {} },
+                    { "SpecularConstant", 1.0f, juce::Range<float>{ 0.0f, 10000.0f }, {} },
+                    { "SurfaceScale", 1.0f, juce::Range<float>{ 0.0f, 10000.0f }, {} },
+                    { "Color", Vector3{ 1.0f, 1.0f, 1.0f }, {}, {} },
+                    { "KernelUnitLength", Vector2{ 1.0f, 1.0f }, {}, {} },
+                    { "ScaleMode", (Enumeration)SpotSpecularLighting::linear, {}, interpolationModes }
+                }
+            }
+        };
+
+        return descriptions[(size_t)type];
+    }
+
     Effect::Effect(Type effectType_) :
         effectType(effectType_),
         pimpl(std::make_shared<Pimpl>(effectType_))
     {
+#if JUCE_WINDOWS
         pimpl->createD2DEffect();
+#endif
     }
 
     Effect::Effect(const Effect& other) :
@@ -499,30 +687,21 @@ namespace mescal
 
     juce::String Effect::getName() const noexcept
     {
-        pimpl->createD2DEffect();
-
-        if (pimpl->d2dEffect)
-        {
-            wchar_t buffer[256];
-            pimpl->d2dEffect->GetValue(D2D1_PROPERTY_DISPLAYNAME, (BYTE*)buffer, sizeof(buffer));
-            return juce::String{ buffer };
-        }
-
-        return {};
+        return pimpl->description.displayName;
     }
 
     void Effect::setInput(int index, juce::Image const& image)
     {
-        pimpl->inputs[index] = image;
+        pimpl->setInput((size_t)index, image);
     }
 
     void Effect::addInput(juce::Image const& image)
     {
-        for (auto& input : pimpl->inputs)
+        for (size_t index = 0; index < pimpl->inputs.size(); ++index)
         {
-            if (std::holds_alternative<std::monostate>(input))
+            if (std::holds_alternative<std::monostate>(pimpl->inputs[index]))
             {
-                input = image;
+                pimpl->setInput(index, image);
                 return;
             }
         }
@@ -530,16 +709,16 @@ namespace mescal
 
     void Effect::setInput(int index, mescal::Effect::Ptr otherEffect)
     {
-        pimpl->inputs[index] = otherEffect;
+        pimpl->setInput((size_t)index, otherEffect);
     }
 
     void Effect::addInput(mescal::Effect::Ptr otherEffect)
     {
-        for (auto& input : pimpl->inputs)
+        for (size_t index = 0; index < pimpl->inputs.size(); ++index)
         {
-            if (std::holds_alternative<std::monostate>(input))
+            if (std::holds_alternative<std::monostate>(pimpl->inputs[index]))
             {
-                input = otherEffect;
+                pimpl->setInput(index, otherEffect);
                 return;
             }
         }
@@ -552,17 +731,36 @@ namespace mescal
 
     int Effect::getNumProperties()
     {
-        return pimpl->getNumProperties();
+        return (int)pimpl->properties.size();
     }
 
     juce::String Effect::getPropertyName(int index)
     {
-        return pimpl->getPropertyName(index);
+        if (!juce::isPositiveAndBelow(index, getNumProperties()))
+            return {};
+
+        return pimpl->description.properties[(size_t)index].name;
     }
 
     void Effect::setPropertyValue(int index, const PropertyValue value)
     {
-        pimpl->setProperty(index, value);
+        if (!juce::isPositiveAndBelow(index, getNumProperties()))
+        {
+            jassertfalse;
+            return;
+        }
+
+        auto normalizedValue = pimpl->normalizePropertyValue(index, value);
+        if (pimpl->properties[(size_t)index] != normalizedValue)
+        {
+            pimpl->properties[(size_t)index] = normalizedValue;
+            pimpl->version.fetch_add(1, std::memory_order_relaxed);
+        }
+
+#if JUCE_WINDOWS
+        if (!pimpl->description.properties[(size_t)index].softwareOnly)
+            pimpl->setD2DProperty(index, value);
+#endif
 
         if (onPropertyChange)
             onPropertyChange(this, index, value);
@@ -570,41 +768,198 @@ namespace mescal
 
     Effect::PropertyValue Effect::getPropertyValue(int index)
     {
-        return pimpl->getProperty(index);
+        if (!juce::isPositiveAndBelow(index, getNumProperties()))
+            return {};
+
+        return pimpl->properties[(size_t)index];
     }
 
     Effect::PropertyInfo Effect::getPropertyInfo(int index)
     {
-        return pimpl->getPropertyInfo(index);
+        if (!juce::isPositiveAndBelow(index, getNumProperties()))
+            return {};
+
+        auto const& property = pimpl->description.properties[(size_t)index];
+        return { property.name, property.range, property.enumeration };
+    }
+
+    uint64_t Effect::getVersion() const noexcept
+    {
+        return pimpl->version.load(std::memory_order_acquire);
+    }
+
+    software::EffectCache& Effect::getSoftwareCache() const noexcept
+    {
+        return pimpl->softwareCache;
+    }
+
+    uint64_t Effect::getInputVersion() const noexcept
+    {
+        return pimpl->inputVersion.load(std::memory_order_acquire);
     }
 
     void Effect::applyEffect(juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination)
     {
-        pimpl->createD2DEffect();
-        if (!pimpl->d2dEffect)
+        applyEffect(outputImage, transform, clearDestination, juce::RectangleList<int>{ outputImage.getBounds() });
+    }
+
+    void Effect::applyEffect(juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination, juce::RectangleList<int> const& dirtyRegion)
+    {
+        if (outputImage.isNull())
+            return;
+
+        auto clippedRegion = dirtyRegion;
+        clippedRegion.clipTo(outputImage.getBounds());
+        if (clippedRegion.isEmpty())
+            return;
+
+#if JUCE_WINDOWS
+        if (pimpl->drawDirect2D(outputImage, transform, clearDestination, clippedRegion))
+            return;
+#endif
+
+        pimpl->drawSoftware(*this, outputImage, transform, clearDestination, clippedRegion);
+    }
+
+    void Effect::setSoftwareBufferLimit(size_t maximumBytes)
+    {
+        software::BufferPool::getInstance().setRetainLimit(maximumBytes);
+    }
+
+    void Effect::releaseSoftwareBuffers()
+    {
+        software::BufferPool::getInstance().trim();
+    }
+
+    struct Effect::Plan::Pimpl
+    {
+        explicit Pimpl(Effect const& effect_) :
+            effect(effect_)
         {
+            renderer.compile(effect);
+        }
+
+#if JUCE_WINDOWS
+        /**
+         * Direct2D keeps the connections between effects, so they only need setting again after an input changes.
+         * The effects are listed with inputs before consumers and checked the other way round, so an upstream effect
+         * is never touched after its consumer has let go of it.
+         *
+         * Image inputs are still set on every run; that's cheap, and a Direct2D image can have new pages after it's
+         * been drawn to.
+         */
+        bool areD2DInputsCurrent() const noexcept
+        {
+            if (boundEffects.empty())
+                return false;
+
+            for (auto bound = boundEffects.rbegin(); bound != boundEffects.rend(); ++bound)
+            {
+                if (bound->first->getInputVersion() != bound->second)
+                    return false;
+            }
+
+            return true;
+        }
+
+        void recordD2DInputs()
+        {
+            boundEffects.clear();
+            recordD2DInputs(effect);
+        }
+
+        void recordD2DInputs(Effect const& upstreamEffect)
+        {
+            for (auto const& bound : boundEffects)
+            {
+                if (bound.first->pimpl == upstreamEffect.pimpl)
+                    return;
+            }
+
+            for (auto const& input : upstreamEffect.getInputs())
+            {
+                if (auto otherEffect = std::get_if<Effect::Ptr>(&input); otherEffect && *otherEffect)
+                    recordD2DInputs(**otherEffect);
+            }
+
+            boundEffects.emplace_back(&upstreamEffect, upstreamEffect.getInputVersion());
+        }
+
+        std::vector<std::pair<Effect const*, uint64_t>> boundEffects;
+#endif
+
+        Effect effect; // shares the Pimpl of the compiled Effect
+        software::EffectRenderer renderer;
+    };
+
+    Effect::Plan Effect::compile()
+    {
+        Plan plan;
+        plan.pimpl = std::make_shared<Plan::Pimpl>(*this);
+        return plan;
+    }
+
+    void Effect::Plan::applyEffect(juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination)
+    {
+        applyEffect(outputImage, transform, clearDestination, juce::RectangleList<int>{ outputImage.getBounds() });
+    }
+
+    void Effect::Plan::applyEffect(juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination, juce::RectangleList<int> const& dirtyRegion)
+    {
+        if (!pimpl || outputImage.isNull())
+            return;
+
+        auto clippedRegion = dirtyRegion;
+        clippedRegion.clipTo(outputImage.getBounds());
+        if (clippedRegion.isEmpty())
             return;
+
+        auto& effect = pimpl->effect;
+
+#if JUCE_WINDOWS
+        auto inputsBound = pimpl->areD2DInputsCurrent();
+        if (inputsBound && effect.pimpl->d2dEffect)
+        {
+            for (auto const& bound : pimpl->boundEffects)
+                bound.first->pimpl->setImageInputs();
         }
 
-        juce::Direct2DPixelData::Ptr outputPixelData = dynamic_cast<juce::Direct2DPixelData*>(outputImage.getPixelData().get());
-        if (!outputPixelData)
+        if (effect.pimpl->drawDirect2D(outputImage, transform, clearDestination, clippedRegion, !inputsBound))
         {
+            if (!inputsBound)
+                pimpl->recordD2DInputs();
+
             return;
         }
+#endif
 
-        Pimpl::setInputsRecursive(pimpl.get());
+        pimpl->renderer.renderCompiled(effect, outputImage, transform, clearDestination, clippedRegion);
+    }
 
-        pimpl->resources->deviceContext->SetTarget(outputPixelData->getFirstPageForDevice(pimpl->resources->adapter->direct2DDevice));
-        pimpl->resources->deviceContext->BeginDraw();
-        if (clearDestination)
-            pimpl->resources->deviceContext->Clear();
+    Effect::ChromaKey Effect::ChromaKey::create(juce::Colour keyColor, float toleranceValue)
+    {
+        auto effect = new Effect{ Effect::Type::chromaKey };
+        effect->setPropertyValue(color, keyColor);
+        effect->setPropertyValue(tolerance, toleranceValue);
+        return effect;
+    }
 
-        if (!transform.isIdentity())
-            pimpl->resources->deviceContext->SetTransform(juce::D2DUtilities::transformToMatrix(transform));
+    Effect::ChromaKey Effect::ChromaKey::withInvertAlpha(bool invert)
+    {
+        get()->setPropertyValue(invertAlpha, invert);
+        return ChromaKey{ *this };
+    }
 
-        pimpl->resources->deviceContext->DrawImage(pimpl->d2dEffect.get());
-        [[maybe_unused]] auto hr = pimpl->resources->deviceContext->EndDraw();
-        jassert(SUCCEEDED(hr));
+    Effect::ChromaKey Effect::ChromaKey::withFeather(bool featherEdges)
+    {
+        get()->setPropertyValue(feather, featherEdges);
+        return ChromaKey{ *this };
+    }
+
+    Effect::ChromaKey Effect::ChromaKey::withDistanceMetric(int metric)
+    {
+        get()->setPropertyValue(distanceMetric, metric);
+        return ChromaKey{ *this };
     }
 
     Effect::Crop Effect::Crop::create(juce::Rectangle<float> cropArea)
@@ -621,6 +976,73 @@ namespace mescal
         return effect;
     }
 
+    Effect::HighlightsAndShadows Effect::HighlightsAndShadows::create(float highlightsValue, float shadowsValue)
+    {
+        auto effect = new Effect{ Effect::Type::highlightsAndShadows };
+        effect->setPropertyValue(highlights, highlightsValue);
+        effect->setPropertyValue(shadows, shadowsValue);
+        return effect;
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::create()
+    {
+        return new Effect{ Effect::Type::spotDiffuseLighting };
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::withLightPosition(float x, float y, float z)
+    {
+        get()->setPropertyValue(lightPosition, Vector3{ x, y, z });
+        return SpotDiffuseLighting{ *this };
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::withPointsAt(float x, float y, float z)
+    {
+        get()->setPropertyValue(pointsAt, Vector3{ x, y, z });
+        return SpotDiffuseLighting{ *this };
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::withFocus(float focusValue)
+    {
+        get()->setPropertyValue(focus, focusValue);
+        return SpotDiffuseLighting{ *this };
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::withLimitingConeAngle(float angle)
+    {
+        get()->setPropertyValue(limitingConeAngle, angle);
+        return SpotDiffuseLighting{ *this };
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::withDiffuseConstant(float constant)
+    {
+        get()->setPropertyValue(diffuseConstant, constant);
+        return SpotDiffuseLighting{ *this };
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::withSurfaceScale(float scale)
+    {
+        get()->setPropertyValue(surfaceScale, scale);
+        return SpotDiffuseLighting{ *this };
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::withColor(juce::Colour colour)
+    {
+        get()->setPropertyValue(color, colour);
+        return SpotDiffuseLighting{ *this };
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::withKernelUnitLength(float x, float y)
+    {
+        get()->setPropertyValue(kernelUnitLength, Vector2{ x, y });
+        return SpotDiffuseLighting{ *this };
+    }
+
+    Effect::SpotDiffuseLighting Effect::SpotDiffuseLighting::withScaleMode(int mode)
+    {
+        get()->setPropertyValue(scaleMode, mode);
+        return SpotDiffuseLighting{ *this };
+    }
+
     Effect::SpotSpecularLighting Effect::SpotSpecularLighting::create()
     {
         return new Effect{ Effect::Type::spotSpecularLighting };
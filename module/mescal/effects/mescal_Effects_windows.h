@@ -13,6 +13,12 @@ inline Vector4 colourToVector4(juce::Colour colour)
     return { colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue(), colour.getFloatAlpha() };
 }
 
+namespace software
+{
+    struct EffectRenderer;
+    struct EffectCache;
+}
+
 /**
 
  The Effect class is a wrapper for built-in Direct2D effects. The effects are processed using shaders
@@ -20,6 +26,9 @@ inline Vector4 colourToVector4(juce::Colour colour)
 
  https://learn.microsoft.com/en-us/windows/win32/direct2d/built-in-effects
 
+ The same effects can also run without a GPU. If the output Image isn't a Direct2D Image, or Direct2D isn't available
+ (for example, on Linux), the effect graph is evaluated on the CPU by a software renderer using multiple threads.
+
  An Effect has a set of inputs and a set of properties. Running the effect processes the inputs according to the effect's
  properties and paints the processed output onto an Image.
 
@@ -103,7 +112,10 @@ inline Vector4 colourToVector4(juce::Colour colour)
 
 Note that applyEffect is only called on the affine transform effect; chained effects are applied recursively in the correct order.
 
-Effects only run in the GPU, so any Image objects used for inputs or outputs must be Direct2D Image objects.
+Effects run in the GPU when the output Image is a Direct2D Image; otherwise, the software renderer paints the output.
+The software renderer supports every effect type: 2D affine transform, 3D perspective transform, alpha mask, arithmetic
+composite, blend, chroma key, composite, crop, edge detection, emboss, flood, Gaussian blur, highlights and shadows, invert,
+luminance to alpha, shadow, spot diffuse lighting, and spot specular lighting.
 
 */
 
@@ -268,12 +280,27 @@ public:
     *
     * Reference: https://learn.microsoft.com/en-us/windows/win32/direct2d/chroma-key
     */
-    struct ChromaKey
+    struct ChromaKey : public Ptr
     {
         static constexpr int color = 0;
         static constexpr int tolerance = 1;
         static constexpr int invertAlpha = 2;
         static constexpr int feather = 3;
+
+        /**
+        * How the distance from the key color is measured. Direct2D always uses RGB, so this property only affects
+        * the software renderer.
+        */
+        static constexpr int distanceMetric = 4;
+
+        static constexpr int rgb = 0;   // Euclidean distance in RGB
+        static constexpr int yCbCr = 1; // Mostly chroma; less sensitive to shading across a green screen
+
+        static ChromaKey create(juce::Colour keyColor, float tolerance);
+        ChromaKey(Effect* effect) : Ptr(effect) { }
+        ChromaKey withInvertAlpha(bool invert);
+        ChromaKey withFeather(bool feather);
+        ChromaKey withDistanceMetric(int metric);
     };
 
     /**
@@ -318,6 +345,9 @@ public:
         static constexpr int rect = 0;
         static constexpr int borderMode = 1;
 
+        static constexpr int soft = 0;
+        static constexpr int hard = 1;
+
         static Crop create(juce::Rectangle<float> cropArea);
         Crop(Effect* effect) : Ptr(effect) {}
     };
@@ -333,6 +363,9 @@ public:
         static constexpr int blurRadius = 1;
         static constexpr int mode = 2;
         static constexpr int overlayEdges = 3;
+
+        static constexpr int sobel = 0;
+        static constexpr int prewitt = 1;
     };
 
     /**
@@ -386,6 +419,26 @@ public:
         GaussianBlur(Effect* effect) : Ptr(effect) { }
     };
 
+    /**
+    * Constants for built-in Direct2D highlights and shadows effect
+    *
+    * Reference: https://learn.microsoft.com/en-us/windows/win32/direct2d/highlights-and-shadows
+    */
+    struct HighlightsAndShadows : public Ptr
+    {
+        static constexpr int highlights = 0;
+        static constexpr int shadows = 1;
+        static constexpr int clarity = 2;
+        static constexpr int inputGamma = 3;
+        static constexpr int maskBlurRadius = 4;
+
+        static constexpr int linear = 0;
+        static constexpr int sRGB = 1;
+
+        static HighlightsAndShadows create(float highlights, float shadows);
+        HighlightsAndShadows(Effect* effect) : Ptr(effect) { }
+    };
+
     /**
     * Constants for built-in Direct2D 3D perspective transform effect
     *
@@ -461,6 +514,8 @@ public:
         static constexpr int anisotropic = 4;
         static constexpr int highQualityCubic = 5;
 
+        static SpotDiffuseLighting create();
+        SpotDiffuseLighting(Effect* effect) : Ptr(effect) { }
         SpotDiffuseLighting withLightPosition(float x, float y, float z);
         SpotDiffuseLighting withPointsAt(float x, float y, float z);
         SpotDiffuseLighting withFocus(float focus);
@@ -578,6 +633,9 @@ public:
     /**
     * Set the input at the specified index to a JUCE Image
     *
+    * The effect listens to the Image's pixel data, so painting into the Image after connecting it marks the effect
+    * as changed.
+    *
     * @param index The index of the input
     * @param image The JUCE Image to use as the input
     */
@@ -606,6 +664,87 @@ public:
     */
     void applyEffect(juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination);
 
+    /**
+    * Run this Effect and repaint only the dirty region of outputImage.
+    *
+    * Pixels outside the dirty region are left untouched. Each effect only computes the part of its output that can
+    * reach the dirty region; for example, a Gaussian blur needs three standard deviations of extra input around the
+    * area it's asked for, a crop stops at its crop rectangle, and an affine transform maps the area through the
+    * inverse of its transform. Use this when only a small part of a large output needs repainting.
+    *
+    * @param outputImage The JUCE Image that will be painted with the output of the effect graph
+    * @param transform The affine transform to apply to the effect output before the effect output is painted onto outputImage
+    * @param clearDestination If true, the dirty region of outputImage will be cleared before the effect output is painted
+    * @param dirtyRegion The area of outputImage to repaint, in outputImage pixel coordinates
+    */
+    void applyEffect(juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination, juce::RectangleList<int> const& dirtyRegion);
+
+    /**
+    * Limit the free memory the software renderer keeps for reuse.
+    *
+    * The software renderer recycles the memory for its intermediate buffers from one render to the next. It keeps
+    * no more free memory than the largest of its last few renders needed, and never more than this limit; the
+    * default is 64 MB. Setting the limit returns anything over it to the system straight away.
+    */
+    static void setSoftwareBufferLimit(size_t maximumBytes);
+
+    /**
+    * Return all of the software renderer's free buffer memory to the system, for example after a one-off large
+    * render or when the application goes into the background
+    */
+    static void releaseSoftwareBuffers();
+
+    /**
+    * A compiled effect graph that can be run many times.
+    *
+    * Effect::applyEffect works out the shape of the graph every time it runs: it walks every input of every
+    * effect, connects the Direct2D effects to each other, and builds the software renderer's sorted list of
+    * nodes. A Plan does that once. Running the plan only picks up what has changed since the last run: new
+    * property values, and new images in input slots.
+    *
+    * The Effect objects in the graph stay live; keep setting their properties and inputs as usual. If an effect
+    * is connected to a different input effect, the plan notices on its next run and compiles itself again.
+    *
+    * \code{.cpp}
+        auto plan = outputEffect->compile();
+
+        // In the paint callback
+        blurEffect->setPropertyValue(mescal::Effect::GaussianBlur::standardDeviation, radius);
+        plan.applyEffect(outputImage, juce::AffineTransform{}, true);
+    \endcode
+    */
+    class Plan
+    {
+    public:
+        Plan() = default;
+
+        /**
+        * Run the compiled graph and paint its output onto outputImage; see Effect::applyEffect
+        */
+        void applyEffect(juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination);
+
+        /**
+        * Run the compiled graph and repaint only the dirty region of outputImage; see Effect::applyEffect
+        */
+        void applyEffect(juce::Image& outputImage, const juce::AffineTransform& transform, bool clearDestination, juce::RectangleList<int> const& dirtyRegion);
+
+        /**
+        * True if this plan was returned by Effect::compile
+        */
+        bool isValid() const noexcept { return pimpl != nullptr; }
+
+    private:
+        struct Pimpl;
+        std::shared_ptr<Pimpl> pimpl;
+
+        friend class Effect;
+    };
+
+    /**
+    * Compile the graph that ends with this Effect into a Plan
+    */
+    Plan compile();
+
     /**
     * Get the number of properties for the effect
     */
@@ -631,6 +770,15 @@ public:
     */
     PropertyInfo getPropertyInfo(int index);
 
+    /**
+    * Get the version number of this effect's properties and inputs
+    *
+    * The version changes whenever a property is set to a different value, an input is set, or an input Image is
+    * painted into. The software renderer keeps the output of each effect in the graph and only re-runs an effect
+    * when its version, or the output of one of its inputs, has changed.
+    */
+    uint64_t getVersion() const noexcept;
+
     Type const effectType;
 
     std::function<void(Effect*, int, PropertyValue)> onPropertyChange;
@@ -639,4 +787,13 @@ protected:
     /** @internal */
     struct Pimpl;
     std::shared_ptr<Pimpl> pimpl;
+
+    friend struct software::EffectRenderer;
+    software::EffectCache& getSoftwareCache() const noexcept;
+
+    /**
+    * Changes whenever an input is set or an input Image is painted into, but not when a property changes; a compiled
+    * graph only needs checking for new connections when this has changed
+    */
+    uint64_t getInputVersion() const noexcept;
 };
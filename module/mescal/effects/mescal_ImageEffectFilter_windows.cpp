@@ -9,7 +9,11 @@ namespace mescal
         {
         }
 
-        static void setInputRecursive(Effect::Ptr effect, juce::Image& sourceImage)
+        /**
+         * The filter's source image goes into every input that's empty when the filter is created. Remember those
+         * inputs so they can be pointed at the new source image each time the filter is applied.
+         */
+        static void findSourceInputsRecursive(Effect::Ptr effect, std::vector<std::pair<Effect::Ptr, int>>& sourceInputs)
         {
             auto inputs = effect->getInputs();
             for (size_t index = 0; index < inputs.size(); ++index)
@@ -19,22 +23,30 @@ namespace mescal
                 {
                     if (auto upstreamEffect = std::get<mescal::Effect::Ptr>(input))
                     {
-                        setInputRecursive(upstreamEffect, sourceImage);
+                        findSourceInputsRecursive(upstreamEffect, sourceInputs);
                     }
                 }
                 else if (std::holds_alternative <std::monostate>(input))
                 {
-                    effect->setInput((uint32_t)index, sourceImage);
+                    sourceInputs.emplace_back(effect, (int)index);
                 }
             }
         }
 
+        void setSourceImage(juce::Image& sourceImage)
+        {
+            for (auto& [inputEffect, index] : sourceInputs)
+                inputEffect->setInput(index, sourceImage);
+        }
+
         Effect::Ptr effect;
+        std::vector<std::pair<Effect::Ptr, int>> sourceInputs;
     };
 
     MescalImageEffectFilter::MescalImageEffectFilter(Effect::Ptr effect_) :
         pimpl(std::make_unique<Pimpl>(effect_))
     {
+        Pimpl::findSourceInputsRecursive(pimpl->effect, pimpl->sourceInputs);
     }
 
     MescalImageEffectFilter::~MescalImageEffectFilter()
@@ -48,8 +60,11 @@ namespace mescal
             outputImage = juce::Image(juce::Image::ARGB, sourceImage.getWidth(), sourceImage.getHeight(), true, juce::NativeImageType{});
         }
 
-        Pimpl::setInputRecursive(pimpl->effect, sourceImage);
-        pimpl->effect->applyEffect(outputImage, juce::AffineTransform::scale(scaleFactor), true);
+        //
+        // Only repaint the part of the output that the destination context can actually draw
+        //
+        pimpl->setSourceImage(sourceImage);
+        pimpl->effect->applyEffect(outputImage, juce::AffineTransform::scale(scaleFactor), true, juce::RectangleList<int>{ destContext.getClipBounds() });
         destContext.setColour(juce::Colours::black);
         destContext.setOpacity(alpha);
         destContext.drawImageAt(outputImage, 0, 0);
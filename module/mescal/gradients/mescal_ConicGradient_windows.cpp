@@ -7,13 +7,18 @@ namespace mescal
         {
         }
 
+#if JUCE_WINDOWS
         void createResources()
         {
             resources->create();
         }
 
-        void draw(juce::Span<Stop> stops, juce::Image image, juce::AffineTransform transform, juce::Colour backgroundColor)
+        bool drawDirect2D(juce::Span<Stop> stops, juce::Image image, juce::AffineTransform transform, juce::Colour backgroundColor)
         {
+            auto pixelData = dynamic_cast<juce::Direct2DPixelData*>(image.getPixelData().get());
+            if (!pixelData)
+                return false;
+
             auto toPOINT_2F = [](juce::Point<float> p)
                 {
                     return D2D1_POINT_2F{ p.x, p.y };
@@ -132,35 +137,52 @@ namespace mescal
             createResources();
 
             auto& deviceContext = resources->deviceContext;
-            if (deviceContext && image.isValid())
+            if (deviceContext)
             {
                 gradientMesh = {};
                 deviceContext->CreateGradientMesh(patches.data(), (uint32_t)patches.size(), gradientMesh.put());
 
                 if (gradientMesh)
                 {
-                    if (auto pixelData = dynamic_cast<juce::Direct2DPixelData*>(image.getPixelData().get()))
+                    if (auto bitmap = pixelData->getFirstPageForDevice(resources->adapter->direct2DDevice))
                     {
-                        if (auto bitmap = pixelData->getFirstPageForDevice(resources->adapter->direct2DDevice))
-                        {
-                            deviceContext->SetTarget(bitmap);
-                            deviceContext->BeginDraw();
-                            deviceContext->SetTransform(D2D1::Matrix3x2F::Identity());
-                            deviceContext->Clear(juce::D2DUtilities::toCOLOR_F(backgroundColor));
-
-                            deviceContext->DrawGradientMesh(gradientMesh.get());
-
-                            deviceContext->EndDraw();
-                            deviceContext->SetTarget(nullptr);
-                        }
+                        deviceContext->SetTarget(bitmap);
+                        deviceContext->BeginDraw();
+                        deviceContext->SetTransform(D2D1::Matrix3x2F::Identity());
+                        deviceContext->Clear(juce::D2DUtilities::toCOLOR_F(backgroundColor));
+
+                        deviceContext->DrawGradientMesh(gradientMesh.get());
+
+                        deviceContext->EndDraw();
+                        deviceContext->SetTarget(nullptr);
                     }
                 }
             }
+
+            return true;
+        }
+#endif
+
+        void drawSoftware(juce::Image image, juce::AffineTransform transform, juce::Colour backgroundColor)
+        {
+            if (lookupTablesDirty)
+            {
+                rasterizer.buildLookupTables(owner.stops);
+                lookupTablesDirty = false;
+            }
+
+            juce::Image::BitmapData bitmapData{ image, juce::Image::BitmapData::writeOnly };
+            rasterizer.render(bitmapData, transform, owner.radiusRange, software::premultiplied(backgroundColor));
         }
 
         ConicGradient& owner;
+        software::ConicRasterizer rasterizer;
+        bool lookupTablesDirty = true;
+
+#if JUCE_WINDOWS
         juce::SharedResourcePointer<DirectXResources> resources;
         winrt::com_ptr<ID2D1GradientMesh> gradientMesh;
+#endif
     };
 
     ConicGradient::ConicGradient() :
@@ -175,6 +197,7 @@ namespace mescal
     void ConicGradient::clearStops()
     {
         stops.clear();
+        pimpl->lookupTablesDirty = true;
     }
 
     void ConicGradient::addStop(float angle, Color128 innerColor, Color128 outerColor)
@@ -194,7 +217,15 @@ namespace mescal
 
     void ConicGradient::draw(juce::Image image, juce::AffineTransform transform, juce::Colour backgroundColor)
     {
-        pimpl->draw(stops, image, transform, backgroundColor);
+        if (!image.isValid())
+            return;
+
+#if JUCE_WINDOWS
+        if (pimpl->drawDirect2D(stops, image, transform, backgroundColor))
+            return;
+#endif
+
+        pimpl->drawSoftware(image, transform, backgroundColor);
     }
 
     void ConicGradient::sortStops()
@@ -203,17 +234,21 @@ namespace mescal
             {
                 return lhs.angle < rhs.angle;
             });
+
+        pimpl->lookupTablesDirty = true;
     }
 
     void ConicGradient::setStopAngle(size_t index, float angle)
     {
         stops[index].angle = angle;
+        pimpl->lookupTablesDirty = true;
     }
 
     void ConicGradient::setStopColor(size_t index, Color128 innerColor, Color128 outerColor)
     {
         stops[index].innerColor = innerColor;
         stops[index].outerColor = outerColor;
+        pimpl->lookupTablesDirty = true;
     }
 
 } // namespace mescal
@@ -4,8 +4,9 @@
  * A conic gradient is a gradient with colors that flow in an elliptical path around a center point. The ConicGradient class
  * stores a set of color stops that define how the colors change at each angular position.
  *
- * The actual gradient is painted by a GPU shader onto a JUCE Image by calling the draw method. Note that the Image needs to
- * be a Direct2D Image.
+ * The actual gradient is painted onto a JUCE Image by calling the draw method. If the Image is a Direct2D Image, the gradient
+ * is painted by a GPU shader; otherwise, each pixel's angle and radius are computed directly in software using SIMD and
+ * multiple threads.
  */
 class ConicGradient
 {
@@ -59,20 +59,214 @@ namespace mescal
         {
         }
 
+#if JUCE_WINDOWS
         void createResources()
         {
             resources->create();
         }
 
+        bool drawDirect2D(juce::Image image, juce::Colour backgroundColor)
+        {
+            auto pixelData = dynamic_cast<juce::Direct2DPixelData*>(image.getPixelData().get());
+            if (!pixelData)
+                return false;
+
+            createResources();
+
+            auto& deviceContext = resources->deviceContext;
+            if (!deviceContext)
+                return true;
+
+            //
+            // Reuse the compiled mesh as long as the patches and the device context haven't changed
+            //
+            if (!gradientMesh || gradientMeshVersion != version || gradientMeshDeviceContext != deviceContext.get())
+            {
+                gradientMesh = {};
+                createGradientMesh(deviceContext.get());
+                gradientMeshVersion = version;
+                gradientMeshDeviceContext = deviceContext.get();
+            }
+
+            if (gradientMesh)
+            {
+                if (auto bitmap = pixelData->getFirstPageForDevice(resources->adapter->direct2DDevice))
+                {
+                    deviceContext->SetTarget(bitmap);
+                    deviceContext->BeginDraw();
+                    deviceContext->SetTransform(D2D1::Matrix3x2F::Identity());
+                    deviceContext->Clear(juce::D2DUtilities::toCOLOR_F(backgroundColor));
+                    deviceContext->DrawGradientMesh(gradientMesh.get());
+                    [[maybe_unused]] auto hr = deviceContext->EndDraw();
+                    jassert(SUCCEEDED(hr));
+                    deviceContext->SetTarget(nullptr);
+                }
+            }
+
+            return true;
+        }
+
+        void createGradientMesh(ID2D1DeviceContext2* deviceContext)
+        {
+            std::vector<D2D1_GRADIENT_MESH_PATCH> d2dPatches{ resolvedPatches.size(), D2D1_GRADIENT_MESH_PATCH{} };
+            auto d2dPatchIterator = d2dPatches.begin();
+            for (auto const& resolvedPatch : resolvedPatches)
+            {
+                auto& d2dPatch = *d2dPatchIterator++;
+                std::array<D2D1_POINT_2F*, 16> d2dPoints
+                {
+                    &d2dPatch.point00, &d2dPatch.point01, &d2dPatch.point02, &d2dPatch.point03,
+                    &d2dPatch.point10, &d2dPatch.point11, &d2dPatch.point12, &d2dPatch.point13,
+                    &d2dPatch.point20, &d2dPatch.point21, &d2dPatch.point22, &d2dPatch.point23,
+                    &d2dPatch.point30, &d2dPatch.point31, &d2dPatch.point32, &d2dPatch.point33
+                };
+
+                auto destinationIterator = d2dPoints.begin();
+                for (auto point : resolvedPatch.points)
+                {
+                    **destinationIterator++ = D2D1_POINT_2F{ point.x, point.y };
+                }
+
+                std::array < D2D1_COLOR_F*, 4> d2dColors
+                {
+                    &d2dPatch.color00, &d2dPatch.color30, &d2dPatch.color33, &d2dPatch.color03
+                };
+
+                auto colorIterator = d2dColors.begin();
+                for (auto color : resolvedPatch.colors)
+                {
+                    **colorIterator = D2D1::ColorF(color.red, color.green, color.blue, color.alpha);
+                    colorIterator++;
+                }
+            }
+
+            deviceContext->CreateGradientMesh(d2dPatches.data(), (uint32_t)d2dPatches.size(), gradientMesh.put());
+        }
+#endif
+
+        void drawSoftware(juce::Image image, juce::Colour backgroundColor)
+        {
+            //
+            // Colors are evaluated per pixel, so a color change alone doesn't need a new tessellation
+            //
+            if (tessellatedVersion.points != version.points)
+                rasterizer.tessellate(owner.numRows, owner.numColumns, resolvedPatches);
+            else if (tessellatedVersion.colors != version.colors)
+                rasterizer.setColors(resolvedPatches);
+
+            tessellatedVersion = version;
+
+            juce::Image::BitmapData bitmapData{ image, juce::Image::BitmapData::writeOnly };
+            rasterizer.render(bitmapData, software::premultiplied(backgroundColor));
+        }
+
+        /**
+         * Gathers each patch's 16 control points from the shared grid into resolvedPatches, substituting the nearest corner
+         * for any control point that hasn't been set.
+         *
+         * The draw transform is applied in the same pass. Each row of a patch's control net is four adjacent points in
+         * the grid, so a row is loaded, transformed, and interleaved into the output with a handful of Vec4 operations;
+         * no transformed copy of the grid is made.
+         */
+        void resolvePoints(juce::AffineTransform const& transform)
+        {
+            static constexpr std::array<size_t, 16> fallbackIndices
+            {
+                0, 0, 3, 3,
+                0, 0, 3, 3,
+                12, 12, 15, 15,
+                12, 12, 15, 15
+            };
+
+            static_assert(sizeof(juce::Point<float>) == sizeof(float) * 2, "resolvePoints writes points as pairs of floats");
+
+            auto const& grid = owner.controlPoints;
+            software::AffineTransformVec4 const coefficients{ transform };
+
+            resolvedPatches.resize((size_t)(owner.numRows * owner.numColumns));
+            auto resolvedPatchIterator = resolvedPatches.begin();
+            for (int row = 0; row < owner.numRows; ++row)
+            {
+                for (int column = 0; column < owner.numColumns; ++column)
+                {
+                    auto& resolvedPatch = *resolvedPatchIterator++;
+                    auto destination = reinterpret_cast<float*>(resolvedPatch.points.data());
+                    uint32_t validMask = 0;
+
+                    for (size_t matrixRow = 0; matrixRow < 4; ++matrixRow)
+                    {
+                        auto gridIndex = grid.getIndex(row, column, matrixRow * Patch::numMatrixColumns);
+                        auto x = software::Vec4::load(grid.x.data() + gridIndex);
+                        auto y = software::Vec4::load(grid.y.data() + gridIndex);
+                        coefficients.apply(x, y);
+
+                        software::Vec4::interleaveLow(x, y).store(destination + matrixRow * 8);
+                        software::Vec4::interleaveHigh(x, y).store(destination + matrixRow * 8 + 4);
+
+                        validMask |= grid.getValidBits(gridIndex, 4) << (matrixRow * 4);
+                    }
+
+                    if (validMask == 0xffff)
+                        continue;
+
+                    for (size_t pointIndex = 0; pointIndex < resolvedPatch.points.size(); ++pointIndex)
+                    {
+                        if ((validMask & (1u << pointIndex)) == 0)
+                            resolvedPatch.points[pointIndex] = resolvedPatch.points[fallbackIndices[pointIndex]];
+                    }
+                }
+            }
+        }
+
+        void resolveColors()
+        {
+            resolvedPatches.resize((size_t)(owner.numRows * owner.numColumns));
+            auto colorIterator = owner.colors.begin();
+            for (auto& resolvedPatch : resolvedPatches)
+            {
+                std::copy(colorIterator, colorIterator + (ptrdiff_t)resolvedPatch.colors.size(), resolvedPatch.colors.begin());
+                colorIterator += (ptrdiff_t)resolvedPatch.colors.size();
+            }
+        }
+
         MeshGradient& owner;
+
+        //
+        // The patches as of the last draw, transformed and with every control point filled in, along with the
+        // MeshGradient point and color versions they were resolved from. Each renderer remembers the version it last
+        // built its mesh from.
+        //
+        struct Version
+        {
+            uint64_t points = 0, colors = 0;
+
+            bool operator!= (Version const& other) const noexcept
+            {
+                return points != other.points || colors != other.colors;
+            }
+        };
+
+        std::vector<software::MeshRasterizer::Patch> resolvedPatches;
+        juce::AffineTransform resolvedTransform;
+        Version version;
+
+        software::MeshRasterizer rasterizer;
+        Version tessellatedVersion;
+
+#if JUCE_WINDOWS
         juce::SharedResourcePointer<DirectXResources> resources;
         winrt::com_ptr<ID2D1GradientMesh> gradientMesh;
+        Version gradientMeshVersion;
+        ID2D1DeviceContext2* gradientMeshDeviceContext = nullptr;
+#endif
     };
 
 
     MeshGradient::MeshGradient(int numRows_, int numColumns_, std::optional<juce::Rectangle<float>> bounds) :
         numRows(numRows_),
         numColumns(numColumns_),
+        controlPoints(numRows_, numColumns_),
+        colors((size_t)(numRows_ * numColumns_) * cornerPlacements.size()),
         pimpl(std::make_unique<Pimpl>(*this))
     {
         jassert(numRows_ > 0);
@@ -81,14 +275,6 @@ namespace mescal
         float rowHeight = 1.0f;
         float columnWidth = 1.0f;
 
-        for (int row = 0; row < numRows_; ++row)
-        {
-            for (int column = 0; column < numColumns_; ++column)
-            {
-                patches.emplace_back(std::make_shared<Patch>(*this, row, column));
-            }
-        }
-
         float startX = 0.0f, startY = 0.0f;
 
         if (bounds.has_value())
@@ -104,7 +290,7 @@ namespace mescal
                 float x = startX;
                 for (int column = 0; column < numColumns_; ++column)
                 {
-                    getPatch(row, column)->setBounds({ x, y, columnWidth, rowHeight });
+                    getPatch(row, column).setBounds({ x, y, columnWidth, rowHeight });
 
                     x += columnWidth;
                 }
@@ -118,16 +304,79 @@ namespace mescal
     {
     }
 
-    void MeshGradient::applyTransform([[maybe_unused]] juce::AffineTransform const& transform)
+    MeshGradient::ControlPointGrid::ControlPointGrid(int numPatchRows, int numPatchColumns) :
+        numRows(numPatchRows * 3 + 1),
+        numColumns(numPatchColumns * 3 + 1),
+        x((size_t)(numRows * numColumns)),
+        y((size_t)(numRows * numColumns)),
+        validBits((x.size() + 63) / 64)
     {
-        jassertfalse;
+    }
+
+    std::vector<MeshGradient::Patch> MeshGradient::getPatches()
+    {
+        std::vector<Patch> views;
+        views.reserve((size_t)(numRows * numColumns));
+
+        for (int row = 0; row < numRows; ++row)
+        {
+            for (int column = 0; column < numColumns; ++column)
+            {
+                views.emplace_back(*this, row, column);
+            }
+        }
+
+        return views;
+    }
+
+    void MeshGradient::applyTransform(juce::AffineTransform const& transform)
+    {
+        //
+        // Unset points are transformed too; they're ignored until they're set, so it does no harm
+        //
+        auto& x = controlPoints.x;
+        auto& y = controlPoints.y;
+        software::transformPoints(transform, x.data(), y.data(), x.data(), y.data(), x.size());
+
+        ++pointsVersion;
     }
 
     MeshGradient::Patch::Patch(MeshGradient& owner_, int row_, int column_) :
         row(row_),
         column(column_),
-        owner(owner_)
+        owner(&owner_)
+    {
+    }
+
+    std::optional<juce::Point<float>> MeshGradient::Patch::getPoint(size_t patchPointIndex) const noexcept
     {
+        auto const& grid = owner->controlPoints;
+        auto index = grid.getIndex(row, column, patchPointIndex);
+        if (!grid.isValid(index))
+            return {};
+
+        return juce::Point<float>{ grid.x[index], grid.y[index] };
+    }
+
+    void MeshGradient::Patch::setPoint(size_t patchPointIndex, std::optional<juce::Point<float>> position)
+    {
+        auto& grid = owner->controlPoints;
+        auto index = grid.getIndex(row, column, patchPointIndex);
+        auto& bits = grid.validBits[index / 64];
+        auto mask = (uint64_t)1 << (index % 64);
+
+        if (position.has_value())
+        {
+            grid.x[index] = position->x;
+            grid.y[index] = position->y;
+            bits |= mask;
+        }
+        else
+        {
+            bits &= ~mask;
+        }
+
+        ++owner->pointsVersion;
     }
 
     void MeshGradient::Patch::setBounds(juce::Rectangle<float> rect)
@@ -166,52 +415,50 @@ namespace mescal
 
     std::optional<juce::Point<float>> MeshGradient::Patch::getPosition(int matrixRow, int matrixColumn) const noexcept
     {
-        return points[matrixRow * numMatrixColumns + matrixColumn];
+        return getPoint((size_t)(matrixRow * numMatrixColumns + matrixColumn));
     }
 
     juce::Point<float> MeshGradient::Patch::getCornerPosition(CornerPlacement placement) const noexcept
     {
-        auto index = cornerIndices[(size_t)placement];
-        jassert(points[index].has_value());
-        return points[index].value_or(juce::Point<float>{});
+        auto point = getPoint(cornerIndices[(size_t)placement]);
+        jassert(point.has_value());
+        return point.value_or(juce::Point<float>{});
     }
 
     void MeshGradient::Patch::setPosition(int matrixRow, int matrixColumn, juce::Point<float> position)
     {
-        points[matrixRow * numMatrixColumns + matrixColumn] = position;
+        setPoint((size_t)(matrixRow * numMatrixColumns + matrixColumn), position);
     }
 
     void MeshGradient::Patch::setCornerPosition(CornerPlacement placement, juce::Point<float> position)
     {
-        auto index = cornerIndices[(size_t)placement];
-        points[index] = position;
+        setPoint(cornerIndices[(size_t)placement], position);
     }
 
     void MeshGradient::Patch::setCornerPositions(juce::Span<juce::Point<float>> positions)
     {
+        auto it = positions.begin();
+        for (auto index : cornerIndices)
         {
-            auto it = positions.begin();
-            for (auto index : cornerIndices)
-            {
-                points[index] = *it;
-                it++;
-            }
+            setPoint(index, *it);
+            it++;
         }
     }
 
     Color128 MeshGradient::Patch::getColor(CornerPlacement placement) const noexcept
     {
-        return colors[(size_t)placement];
+        return owner->colors[(size_t)(row * owner->numColumns + column) * cornerPlacements.size() + (size_t)placement];
     }
 
     void MeshGradient::Patch::setColor(CornerPlacement placement, juce::Colour color)
     {
-        colors[(size_t)placement] = color;
+        setColor(placement, Color128{ color });
     }
 
     void MeshGradient::Patch::setColor(CornerPlacement placement, Color128 color)
     {
-        colors[(size_t)placement] = color;
+        owner->colors[(size_t)(row * owner->numColumns + column) * cornerPlacements.size() + (size_t)placement] = color;
+        ++owner->colorsVersion;
     }
 
     void MeshGradient::Patch::setEdge(EdgePlacement edgePlacement, Edge edge)
@@ -221,8 +468,8 @@ namespace mescal
         setCornerPosition(headCornerPlacement, edge.head);
 
         auto [bezierIndex0, bezierIndex1] = edgeBezierControlPointIndices[(size_t)edgePlacement];
-        points[bezierIndex0] = edge.bezierControlPoints.first;
-        points[bezierIndex1] = edge.bezierControlPoints.second;
+        setPoint(bezierIndex0, edge.bezierControlPoints.first);
+        setPoint(bezierIndex1, edge.bezierControlPoints.second);
     }
 
     MeshGradient::Edge MeshGradient::Patch::getEdge(EdgePlacement edgePlacement) const noexcept
@@ -234,33 +481,31 @@ namespace mescal
         edge.head = getCornerPosition(headCornerPlacement);
 
         auto [bezierIndex0, bezierIndex1] = edgeBezierControlPointIndices[(size_t)edgePlacement];
-        edge.bezierControlPoints = std::make_pair(points[bezierIndex0], points[bezierIndex1]);
+        edge.bezierControlPoints = std::make_pair(getPoint(bezierIndex0), getPoint(bezierIndex1));
 
         return edge;
     }
 
-    std::optional<juce::Point<float>> MeshGradient::Patch::getBezierControlPointPosition(EdgePlacement edgePlacement, BezierControlPointPlacement bezierControlPointPlacement)
+    std::optional<juce::Point<float>> MeshGradient::Patch::getBezierControlPointPosition(EdgePlacement edgePlacement, BezierControlPointPlacement bezierControlPointPlacement) const noexcept
     {
         auto indexPair = MeshGradient::edgeBezierControlPointIndices[(size_t)edgePlacement];
-        return points[ bezierControlPointPlacement == MeshGradient::BezierControlPointPlacement::first ? indexPair.first : indexPair.second];
+        return getPoint(bezierControlPointPlacement == MeshGradient::BezierControlPointPlacement::first ? indexPair.first : indexPair.second);
     }
 
     void MeshGradient::Patch::setBezierControlPointPosition(EdgePlacement edgePlacement, BezierControlPointPlacement bezierControlPointPlacement, juce::Point<float> position)
     {
         auto indexPair = MeshGradient::edgeBezierControlPointIndices[(size_t)edgePlacement];
-        points[bezierControlPointPlacement == MeshGradient::BezierControlPointPlacement::first ? indexPair.first : indexPair.second] = position;
+        setPoint(bezierControlPointPlacement == MeshGradient::BezierControlPointPlacement::first ? indexPair.first : indexPair.second, position);
     }
 
-    std::optional<juce::Point<float>> MeshGradient::Patch::getInteriorControlPointPosition(CornerPlacement placement)
+    std::optional<juce::Point<float>> MeshGradient::Patch::getInteriorControlPointPosition(CornerPlacement placement) const noexcept
     {
-        auto index = interiorControlIndices[(size_t)placement];
-        return points[index];
+        return getPoint(interiorControlIndices[(size_t)placement]);
     }
 
     void MeshGradient::Patch::setInteriorControlPointPosition(CornerPlacement placement, juce::Point<float> position)
     {
-        auto index = interiorControlIndices[(size_t)placement];
-        points[index] = position;
+        setPoint(interiorControlIndices[(size_t)placement], position);
     }
 
     std::pair<MeshGradient::CornerPlacement, MeshGradient::CornerPlacement> MeshGradient::Patch::edgeToCornerPlacements(EdgePlacement edgePlacement)
@@ -272,101 +517,31 @@ namespace mescal
 
     void MeshGradient::draw(juce::Image image, juce::AffineTransform transform, juce::Colour backgroundColor)
     {
-        auto pointToPOINT_2F = [&](juce::Point<float> p)
-            {
-                p = p.transformedBy(transform);
-                return D2D1_POINT_2F{ p.x, p.y };
-            };
-
-        auto toCOLOR_F = [](Color128 color)
-            {
-                return D2D1::ColorF(color.red, color.green, color.blue, color.alpha);
-            };
+        if (!image.isValid())
+            return;
 
-        std::vector<D2D1_GRADIENT_MESH_PATCH> d2dPatches{ patches.size(), D2D1_GRADIENT_MESH_PATCH{} };
-        auto d2dPatchIterator = d2dPatches.begin();
-        for (auto const& patch : patches)
+        //
+        // Only resolve the points or colors again if they changed since the last draw
+        //
+        if (transform != pimpl->resolvedTransform)
         {
-            auto& d2dPatch = *d2dPatchIterator++;
-            std::array<D2D1_POINT_2F*, 16> d2dPoints
-            {
-                &d2dPatch.point00, &d2dPatch.point01, &d2dPatch.point02, &d2dPatch.point03,
-                &d2dPatch.point10, &d2dPatch.point11, &d2dPatch.point12, &d2dPatch.point13,
-                &d2dPatch.point20, &d2dPatch.point21, &d2dPatch.point22, &d2dPatch.point23,
-                &d2dPatch.point30, &d2dPatch.point31, &d2dPatch.point32, &d2dPatch.point33
-            };
-
-            std::array<D2D1_POINT_2F*, 16> d2dFallbackPoints
-            {
-                &d2dPatch.point00, &d2dPatch.point00, &d2dPatch.point03, &d2dPatch.point03,
-                &d2dPatch.point00, &d2dPatch.point00, &d2dPatch.point03, &d2dPatch.point03,
-                &d2dPatch.point30, &d2dPatch.point30, &d2dPatch.point33, &d2dPatch.point33,
-                &d2dPatch.point30, &d2dPatch.point30, &d2dPatch.point33, &d2dPatch.point33
-            };
-
-            auto destinationIterator = d2dPoints.begin();
-            for (auto point : patch->points)
-            {
-                if (point.has_value())
-                {
-                    **destinationIterator = pointToPOINT_2F(*point);
-                }
-
-                ++destinationIterator;
-            }
-
-            destinationIterator = d2dPoints.begin();
-            auto fallbackIterator = d2dFallbackPoints.begin();
-            for (auto point : patch->points)
-            {
-                if (!point.has_value())
-                {
-                    **destinationIterator = **fallbackIterator;
-                }
-
-                ++destinationIterator;
-                ++fallbackIterator;
-            }
-
-            std::array < D2D1_COLOR_F*, 4> d2dColors
-            {
-                &d2dPatch.color00, &d2dPatch.color30, &d2dPatch.color33, &d2dPatch.color03
-            };
-
-            auto colorIterator = d2dColors.begin();
-            for (auto color : patch->colors)
-            {
-                **colorIterator = toCOLOR_F(color);
-                colorIterator++;
-            }
+            pimpl->resolvedTransform = transform;
+            ++pointsVersion;
         }
 
-        pimpl->createResources();
+        Pimpl::Version currentVersion{ pointsVersion, colorsVersion };
+        if (pimpl->version.points != currentVersion.points)
+            pimpl->resolvePoints(transform);
+        if (pimpl->version.colors != currentVersion.colors)
+            pimpl->resolveColors();
+        pimpl->version = currentVersion;
 
-        auto& deviceContext = pimpl->resources->deviceContext;
-        if (deviceContext && image.isValid())
-        {
-            pimpl->gradientMesh = {};
-            deviceContext->CreateGradientMesh(d2dPatches.data(), (uint32_t)d2dPatches.size(), pimpl->gradientMesh.put());
+#if JUCE_WINDOWS
+        if (pimpl->drawDirect2D(image, backgroundColor))
+            return;
+#endif
 
-            if (pimpl->gradientMesh)
-            {
-                if (auto pixelData = dynamic_cast<juce::Direct2DPixelData*>(image.getPixelData().get()))
-                {
-                    if (auto bitmap = pixelData->getFirstPageForDevice(pimpl->resources->adapter->direct2DDevice))
-                    {
-                        deviceContext->SetTarget(bitmap);
-                        deviceContext->BeginDraw();
-                        deviceContext->SetTransform(D2D1::Matrix3x2F::Identity());
-                        deviceContext->Clear(juce::D2DUtilities::toCOLOR_F(backgroundColor));
-                        deviceContext->DrawGradientMesh(pimpl->gradientMesh.get());
-                        [[maybe_unused]] auto hr = deviceContext->EndDraw();
-                        jassert(SUCCEEDED(hr));
-                        deviceContext->SetTarget(nullptr);
-                    }
-                }
-            }
-        }
+        pimpl->drawSoftware(image, backgroundColor);
     }
 
     Color128 Color128::fromHSV(float hue, float saturation, float brightness, float alpha) noexcept
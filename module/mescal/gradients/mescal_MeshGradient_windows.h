@@ -54,8 +54,8 @@ struct Color128
 
  \image html 8x8_side_by_side.webp width=50%
 
- * The actual gradient is painted by a GPU shader onto a JUCE Image by calling the draw method. Note that the Image needs to
- * be a Direct2D Image.
+ * The actual gradient is painted onto a JUCE Image by calling the draw method. If the Image is a Direct2D Image, the gradient
+ * is painted by a GPU shader; otherwise, the patches are tessellated and rasterized in software using multiple threads.
  *
  */
 
@@ -129,12 +129,18 @@ public:
         juce::Point<float> head;
     };
 
+    /**
+     * A lightweight view of a single patch in the mesh. A Patch doesn't store any points or colors itself; those live in the
+     * MeshGradient, and neighboring patches share the points along their common edges. Moving a corner of one patch
+     * moves the matching corner of every adjacent patch.
+     *
+     * Patches are cheap to copy. A Patch is only valid for as long as the MeshGradient that created it.
+     */
     struct Patch
     {
         Patch(MeshGradient& owner_, int row_, int column_);
 
-        int const row, column;
-        MeshGradient& owner;
+        int row, column;
 
         void setBounds(juce::Rectangle<float> rect);
 
@@ -152,18 +158,21 @@ public:
         void setEdge(EdgePlacement placement, Edge edge);
         Edge getEdge(EdgePlacement placement) const noexcept;
 
-        std::optional<juce::Point<float>> getBezierControlPointPosition(EdgePlacement edgePlacement, BezierControlPointPlacement bezierControlPointPlacement);
+        std::optional<juce::Point<float>> getBezierControlPointPosition(EdgePlacement edgePlacement, BezierControlPointPlacement bezierControlPointPlacement) const noexcept;
         void setBezierControlPointPosition(EdgePlacement edgePlacement, BezierControlPointPlacement bezierControlPointPlacement, juce::Point<float> position);
 
-        std::optional<juce::Point<float>> getInteriorControlPointPosition(CornerPlacement placement);
+        std::optional<juce::Point<float>> getInteriorControlPointPosition(CornerPlacement placement) const noexcept;
         void setInteriorControlPointPosition(CornerPlacement placement, juce::Point<float> position);
 
-        std::array<std::optional<juce::Point<float>>, 16> points;
-        std::array<Color128, 4> colors;
-
         static constexpr size_t numMatrixColumns = 4;
 
         static std::pair<CornerPlacement, CornerPlacement> edgeToCornerPlacements(EdgePlacement edgePlacement);
+
+    private:
+        MeshGradient* owner;
+
+        std::optional<juce::Point<float>> getPoint(size_t patchPointIndex) const noexcept;
+        void setPoint(size_t patchPointIndex, std::optional<juce::Point<float>> position);
     };
 
     int getNumRows() const
@@ -189,14 +198,12 @@ public:
     }
 #endif
 
-    auto const& getPatches() const noexcept
-    {
-        return patches;
-    }
+    std::vector<Patch> getPatches();
 
-    std::shared_ptr<Patch> getPatch(int row, int column)
+    Patch getPatch(int row, int column)
     {
-        return patches[row * numColumns + column];
+        jassert(juce::isPositiveAndBelow(row, numRows) && juce::isPositiveAndBelow(column, numColumns));
+        return Patch{ *this, row, column };
     }
 
     juce::Rectangle<float> getBounds() const noexcept;
@@ -209,7 +216,57 @@ private:
     int const numRows;
     int const numColumns;
 
-    std::vector<std::shared_ptr<Patch>> patches;
+    /**
+     * Control points for the whole mesh in structure-of-arrays form. Adjacent patches share their corners and edge
+     * control points, so the mesh is a single grid of (3 * numRows + 1) x (3 * numColumns + 1) points with each point
+     * stored once. Coordinates live in flat x and y arrays; one bit per point records whether the point has been set.
+     */
+    struct ControlPointGrid
+    {
+        ControlPointGrid(int numPatchRows, int numPatchColumns);
+
+        int const numRows;
+        int const numColumns;
+        std::vector<float> x, y;
+        std::vector<uint64_t> validBits;
+
+        size_t getIndex(int patchRow, int patchColumn, size_t patchPointIndex) const noexcept
+        {
+            auto row = patchRow * 3 + (int)(patchPointIndex / Patch::numMatrixColumns);
+            auto column = patchColumn * 3 + (int)(patchPointIndex % Patch::numMatrixColumns);
+            return (size_t)(row * numColumns + column);
+        }
+
+        bool isValid(size_t index) const noexcept
+        {
+            return (validBits[index / 64] >> (index % 64)) & 1;
+        }
+
+        /**
+         * Returns the valid bits for count consecutive points starting at index, with the first point in bit 0
+         */
+        uint32_t getValidBits(size_t index, int count) const noexcept
+        {
+            auto word = index / 64;
+            auto shift = index % 64;
+            auto bits = validBits[word] >> shift;
+            if (shift + (size_t)count > 64)
+                bits |= validBits[word + 1] << (64 - shift);
+
+            return (uint32_t)(bits & ((1ull << count) - 1));
+        }
+    } controlPoints;
+
+    /**
+     * Four corner colors per patch, packed in patch order; each patch's colors are in cornerPlacements order
+     */
+    std::vector<Color128> colors;
+
+    /**
+     * Bumped whenever any point or color changes so draw can tell when its cached mesh is out of date
+     */
+    uint64_t pointsVersion = 1;
+    uint64_t colorsVersion = 1;
 
     struct Pimpl;
     std::unique_ptr<Pimpl> pimpl;
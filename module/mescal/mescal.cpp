@@ -20,6 +20,7 @@
     SOFTWARE.
 */
 
+#ifdef _WIN32
 #define _SILENCE_CLANG_COROUTINE_MESSAGE 1
 #include <windows.h>
 #include <winrt/Windows.Foundation.h>
@@ -29,8 +30,10 @@
 #include <d2d1effectauthor.h>
 #include <d2d1effecthelpers.h>
 #define JUCE_CORE_INCLUDE_COM_SMART_PTR 1
+#endif
 #include <juce_core/juce_core.h>
 #include <juce_graphics/juce_graphics.h>
+#if JUCE_WINDOWS
 #include <juce_graphics/native/juce_Direct2DMetrics_windows.h>
 #include <juce_graphics/native/juce_EventTracing.h>
 #include <juce_graphics/native/juce_DirectX_windows.h>
@@ -38,15 +41,37 @@
 #include <juce_graphics/native/juce_Direct2DImage_windows.h>
 #include <juce_graphics/native/juce_Direct2DGraphicsContext_windows.h>
 #include <juce_graphics/native/juce_Direct2DImageContext_windows.h>
+#endif
 
 #include "mescal.h"
 
 #include "json/mescal_JSON.cpp"
+#include "software/mescal_Parallel.cpp"
+#include "software/mescal_BufferPool.cpp"
+#include "software/mescal_SIMD.cpp"
+#include "software/mescal_Pixels.cpp"
+#include "software/mescal_MeshRasterizer.cpp"
+#include "software/mescal_ConicRasterizer.cpp"
+#include "software/mescal_EffectKernels.cpp"
+#include "software/mescal_BlurKernels.cpp"
+#include "software/mescal_BlendKernels.cpp"
+#include "software/mescal_CompositeKernels.cpp"
+#include "software/mescal_ChromaKeyKernels.cpp"
+#include "software/mescal_ResampleKernels.cpp"
+#include "software/mescal_LightingKernels.cpp"
+#include "software/mescal_ConvolutionKernels.cpp"
+#include "software/mescal_ToneKernels.cpp"
+#include "software/mescal_FusedEffectKernel.cpp"
+#include "software/mescal_EffectRenderer.cpp"
+#if JUCE_WINDOWS
 #include "resources/mescal_Resources_windows.cpp"
+#endif
 #include "gradients/mescal_MeshGradient_windows.cpp"
 #include "gradients/mescal_ConicGradient_windows.cpp"
 #include "effects/mescal_Effects_windows.cpp"
 #include "effects/mescal_ImageEffectFilter_windows.cpp"
+#if JUCE_WINDOWS
 #include "images/mescal_Image_windows.cpp"
 #include "utility/mescal_GPU_windows.cpp"
 #include "sprites/mescal_SpriteBatch_windows.cpp"
+#endif
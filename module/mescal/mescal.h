@@ -48,7 +48,9 @@ namespace mescal
     #include "gradients/mescal_ConicGradient_windows.h"
     #include "effects/mescal_Effects_windows.h"
     #include "effects/mescal_ImageEffectFilter_windows.h"
+#if JUCE_WINDOWS
     #include "images/mescal_Image_windows.h"
     #include "utility/mescal_GPU_windows.h"
     #include "sprites/mescal_SpriteBatch_windows.h"
+#endif
 }
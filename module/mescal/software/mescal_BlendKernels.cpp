@@ -0,0 +1,270 @@
+namespace mescal::software
+{
+    /*
+
+        Blend kernels for the software effect renderer
+
+        Each of the 26 Effect::Blend modes gets its own instantiation of blendRow, so the per-pixel code has no mode
+        switch and the compiler can inline the blend function into the loop. getRowFunction looks the mode up in a
+        table once, and the caller runs the returned function on every row.
+
+        Pixels are premultiplied Color128 values held in a Vec4. The separable modes blend all three color channels
+        at once with Vec4 arithmetic, using Vec4::select in place of the per-channel branches in the W3C formulas.
+        The non-separable modes (hue, saturation, color, luminosity, darker color and lighter color) mix the channels
+        together, so they work on the straight color as three floats.
+
+    */
+    struct BlendKernels
+    {
+        using RowFunction = void (*)(Color128* destination, Color128 const* source, int width, int x, int y) noexcept;
+
+        static constexpr int numModes = Effect::Blend::division + 1;
+
+        /**
+         * Blends the source (input 1) onto the destination (input 0) using the W3C compositing formulas:
+         *
+         *      result = source * (1 - destination alpha) + destination * (1 - source alpha) + source alpha * destination alpha * B(destination, source)
+         *
+         * where B is the blend function applied to the straight colors.
+         */
+        static void blend(PixelBuffer& destination, PixelBuffer const& source, int mode)
+        {
+            jassert(source.area == destination.area);
+
+            auto blendRow = getRowFunction(mode);
+            auto const& area = destination.area;
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                        blendRow(destination.getRow(y), source.getRow(y), area.getWidth(), area.getX(), y);
+                });
+        }
+
+        /**
+         * The row kernel for a blend mode; unknown modes show the source over the destination
+         */
+        static RowFunction getRowFunction(int mode) noexcept
+        {
+            static auto const table = makeTable(std::make_integer_sequence<int, numModes>{});
+
+            if (mode < 0 || mode >= numModes)
+                return blendRow<-1>;
+
+            return table[(size_t)mode];
+        }
+
+        /**
+         * Blends a row of source pixels onto a row of destination pixels; x and y are the effect space position of
+         * the first pixel, which the dissolve mode uses to pick its pattern
+         */
+        template <int mode>
+        static void blendRow(Color128* destination, Color128 const* source, int width, int x, int y) noexcept
+        {
+            for (int column = 0; column < width; ++column)
+                destination[column] = blendPixel<mode>(destination[column], source[column], x + column, y);
+        }
+
+        template <int mode>
+        static Color128 blendPixel(Color128 destination, Color128 source, int x, int y) noexcept
+        {
+            auto sourceAlpha = source.alpha;
+            auto destinationAlpha = destination.alpha;
+
+            if (sourceAlpha <= 0.0f)
+                return destination;
+
+            if constexpr (mode == Effect::Blend::dissolve)
+            {
+                //
+                // Show the opaque source color with a probability equal to the source alpha
+                //
+                auto hash = (uint32_t)x * 0x9e3779b1u ^ (uint32_t)y * 0x85ebca77u;
+                hash ^= hash >> 15;
+                hash *= 0x2c1b3c6du;
+                hash ^= hash >> 12;
+                if ((float)(hash & 0xffffff) * (1.0f / 16777216.0f) >= sourceAlpha)
+                    return destination;
+
+                return { source.red / sourceAlpha, source.green / sourceAlpha, source.blue / sourceAlpha, 1.0f };
+            }
+            else
+            {
+                if (destinationAlpha <= 0.0f)
+                    return source;
+
+                auto sourcePixel = Vec4::fromColor(source);
+                auto destinationPixel = Vec4::fromColor(destination);
+                Vec4 const sourceAlphas{ sourceAlpha }, destinationAlphas{ destinationAlpha }, one{ 1.0f };
+
+                //
+                // The alpha lane of the blended color is 1, which makes the alpha lane of the result
+                // sourceAlpha + destinationAlpha - sourceAlpha * destinationAlpha
+                //
+                auto blended = blendColors<mode>(destinationPixel / destinationAlphas, sourcePixel / sourceAlphas);
+                blended = Vec4::select(EffectKernels::getColorLanes(), blended, one);
+
+                return (sourcePixel * (one - destinationAlphas) + destinationPixel * (one - sourceAlphas)
+                    + sourceAlphas * destinationAlphas * blended).toColor();
+            }
+        }
+
+    private:
+        template <int... modes>
+        static constexpr std::array<RowFunction, sizeof...(modes)> makeTable(std::integer_sequence<int, modes...>) noexcept
+        {
+            return { blendRow<modes>... };
+        }
+
+        /**
+         * B(backdrop, source) on straight colors; only the red, green, and blue lanes of the result are used
+         */
+        template <int mode>
+        static Vec4 blendColors(Vec4 backdrop, Vec4 source) noexcept
+        {
+            Vec4 const zero, half{ 0.5f }, one{ 1.0f }, two{ 2.0f };
+
+            if constexpr (mode == Effect::Blend::multiply) return backdrop * source;
+            else if constexpr (mode == Effect::Blend::screen) return backdrop + source - backdrop * source;
+            else if constexpr (mode == Effect::Blend::darken) return Vec4::min(backdrop, source);
+            else if constexpr (mode == Effect::Blend::lighten) return Vec4::max(backdrop, source);
+            else if constexpr (mode == Effect::Blend::colorBurn) return colorBurn(backdrop, source);
+            else if constexpr (mode == Effect::Blend::linearBurn) return Vec4::max(zero, backdrop + source - one);
+            else if constexpr (mode == Effect::Blend::colorDodge) return colorDodge(backdrop, source);
+            else if constexpr (mode == Effect::Blend::linearDodge) return Vec4::min(one, backdrop + source);
+            else if constexpr (mode == Effect::Blend::overlay) return hardLight(source, backdrop);
+            else if constexpr (mode == Effect::Blend::softLight)
+            {
+                auto darker = backdrop - (one - two * source) * backdrop * (one - backdrop);
+                auto curve = Vec4::select(Vec4::lessThan(Vec4{ 0.25f }, backdrop),
+                    Vec4::sqrt(backdrop),
+                    ((Vec4{ 16.0f } * backdrop - Vec4{ 12.0f }) * backdrop + Vec4{ 4.0f }) * backdrop);
+                auto lighter = backdrop + (two * source - one) * (curve - backdrop);
+                return Vec4::select(Vec4::lessThan(half, source), lighter, darker);
+            }
+            else if constexpr (mode == Effect::Blend::hardLight) return hardLight(backdrop, source);
+            else if constexpr (mode == Effect::Blend::vividLight) return vividLight(backdrop, source);
+            else if constexpr (mode == Effect::Blend::linearLight) return Vec4::clamp(backdrop + two * source - one, 0.0f, 1.0f);
+            else if constexpr (mode == Effect::Blend::pinLight)
+                return Vec4::select(Vec4::lessThan(half, source), Vec4::max(backdrop, two * source - one), Vec4::min(backdrop, two * source));
+            else if constexpr (mode == Effect::Blend::hardMix) return Vec4::select(Vec4::lessThan(vividLight(backdrop, source), half), zero, one);
+            else if constexpr (mode == Effect::Blend::difference) return Vec4::abs(backdrop - source);
+            else if constexpr (mode == Effect::Blend::exclusion) return backdrop + source - two * backdrop * source;
+            else if constexpr (mode == Effect::Blend::subtract) return Vec4::max(zero, backdrop - source);
+            else if constexpr (mode == Effect::Blend::division)
+                return Vec4::select(Vec4::lessThan(zero, source), Vec4::min(one, backdrop / source), one);
+            else if constexpr (mode == Effect::Blend::darkerColor
+                || mode == Effect::Blend::lighterColor
+                || mode == Effect::Blend::hue
+                || mode == Effect::Blend::saturation
+                || mode == Effect::Blend::color
+                || mode == Effect::Blend::luminosity)
+            {
+                return fromRGB(blendNonSeparable<mode>(toRGB(backdrop), toRGB(source)));
+            }
+            else
+            {
+                return source;
+            }
+        }
+
+        static Vec4 colorBurn(Vec4 backdrop, Vec4 source) noexcept
+        {
+            Vec4 const zero, one{ 1.0f };
+            auto result = one - Vec4::min(one, (one - backdrop) / source);
+            result = Vec4::select(Vec4::lessThan(zero, source), result, zero);
+            return Vec4::select(Vec4::lessThan(backdrop, one), result, one);
+        }
+
+        static Vec4 colorDodge(Vec4 backdrop, Vec4 source) noexcept
+        {
+            Vec4 const zero, one{ 1.0f };
+            auto result = Vec4::min(one, backdrop / (one - source));
+            result = Vec4::select(Vec4::lessThan(source, one), result, one);
+            return Vec4::select(Vec4::lessThan(zero, backdrop), result, zero);
+        }
+
+        static Vec4 hardLight(Vec4 backdrop, Vec4 source) noexcept
+        {
+            Vec4 const one{ 1.0f }, two{ 2.0f };
+            auto screenSource = two * source - one;
+            return Vec4::select(Vec4::lessThan(Vec4{ 0.5f }, source),
+                backdrop + screenSource - backdrop * screenSource,
+                backdrop * two * source);
+        }
+
+        static Vec4 vividLight(Vec4 backdrop, Vec4 source) noexcept
+        {
+            Vec4 const half{ 0.5f }, two{ 2.0f };
+            return Vec4::select(Vec4::lessThan(half, source),
+                colorDodge(backdrop, two * (source - half)),
+                colorBurn(backdrop, two * source));
+        }
+
+        using RGB = std::array<float, 3>;
+
+        static RGB toRGB(Vec4 color) noexcept
+        {
+            auto pixel = color.toColor();
+            return { pixel.red, pixel.green, pixel.blue };
+        }
+
+        static Vec4 fromRGB(RGB color) noexcept
+        {
+            return { color[0], color[1], color[2], 1.0f };
+        }
+
+        template <int mode>
+        static RGB blendNonSeparable(RGB backdrop, RGB source) noexcept
+        {
+            if constexpr (mode == Effect::Blend::darkerColor) return luminosity(source) < luminosity(backdrop) ? source : backdrop;
+            else if constexpr (mode == Effect::Blend::lighterColor) return luminosity(source) > luminosity(backdrop) ? source : backdrop;
+            else if constexpr (mode == Effect::Blend::hue) return setLuminosity(setSaturation(source, saturation(backdrop)), luminosity(backdrop));
+            else if constexpr (mode == Effect::Blend::saturation) return setLuminosity(setSaturation(backdrop, saturation(source)), luminosity(backdrop));
+            else if constexpr (mode == Effect::Blend::color) return setLuminosity(source, luminosity(backdrop));
+            else return setLuminosity(backdrop, luminosity(source));
+        }
+
+        static float luminosity(RGB color) noexcept
+        {
+            return 0.3f * color[0] + 0.59f * color[1] + 0.11f * color[2];
+        }
+
+        static float saturation(RGB color) noexcept
+        {
+            return juce::jmax(color[0], color[1], color[2]) - juce::jmin(color[0], color[1], color[2]);
+        }
+
+        static RGB setLuminosity(RGB color, float targetLuminosity) noexcept
+        {
+            auto delta = targetLuminosity - luminosity(color);
+            for (auto& channel : color)
+                channel += delta;
+
+            auto lum = luminosity(color);
+            auto lowest = juce::jmin(color[0], color[1], color[2]);
+            auto highest = juce::jmax(color[0], color[1], color[2]);
+
+            for (auto& channel : color)
+            {
+                if (lowest < 0.0f)
+                    channel = lum + (channel - lum) * lum / (lum - lowest);
+                if (highest > 1.0f)
+                    channel = lum + (channel - lum) * (1.0f - lum) / (highest - lum);
+            }
+
+            return color;
+        }
+
+        static RGB setSaturation(RGB color, float targetSaturation) noexcept
+        {
+            auto lowest = juce::jmin(color[0], color[1], color[2]);
+            auto range = juce::jmax(color[0], color[1], color[2]) - lowest;
+
+            for (auto& channel : color)
+                channel = range > 0.0f ? (channel - lowest) * targetSaturation / range : 0.0f;
+
+            return color;
+        }
+    };
+
+} // namespace mescal::software
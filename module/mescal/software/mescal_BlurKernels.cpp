@@ -0,0 +1,623 @@
+namespace mescal::software
+{
+    /*
+
+        Gaussian blur kernels for the software effect renderer
+
+        The blur is separable: a horizontal pass filters each row into an intermediate buffer, then a vertical pass
+        filters the columns of that buffer. Rows are split into bands and columns into narrow strips so that both
+        passes run on the shared worker pool and the vertical pass still reads memory a row at a time.
+
+        The optimization property picks the filter, matching the trade-offs Direct2D offers:
+
+            speed       Young & van Vliet recursive (IIR) filter; the cost per pixel doesn't depend on the standard deviation
+            balanced    Three stacked box blurs with running sums; also independent of the standard deviation
+            quality     Exact convolution with a Gaussian kernel truncated at three standard deviations
+
+        Small blurs always use the exact kernel since it's already cheap and the approximations are least accurate there.
+
+        Large soft-edged blurs with the speed or balanced setting run on a pyramid instead: the source is averaged
+        down by a power of two, blurred at the lower resolution, and scaled back up with bilinear interpolation. The
+        averaging and interpolation blur the image as well, so the low-resolution blur is reduced to leave the total
+        variance unchanged. The low-resolution image is small enough to blur with the exact kernel, so the only
+        approximation is the resampling. The scale factor is picked so the low-resolution standard deviation stays
+        at or above minimumPyramidStandardDeviation, which keeps the difference from the exact kernel within two
+        8-bit levels; that's closer than the full-resolution box and recursive filters get.
+
+        Every kernel here is templated on the sample type, so alpha-only buffers are blurred with a quarter of the
+        memory traffic of color buffers. Shadows only need the source alpha, so they always blur an AlphaBuffer and
+        apply the shadow color afterwards.
+
+    */
+    struct BlurKernels
+    {
+        static constexpr int columnsPerStrip = 16;
+        static constexpr float minimumApproximateStandardDeviation = 2.0f;
+        static constexpr float minimumPyramidStandardDeviation = 2.0f;
+        static constexpr int maximumPyramidScale = 64;
+
+        /**
+         * How far the blur reaches; every filter's support fits within this radius
+         */
+        static int getBlurRadius(float standardDeviation) noexcept
+        {
+            if (standardDeviation <= 0.0f)
+                return 0;
+
+            auto boxRadii = getBoxRadii(standardDeviation);
+            auto radius = juce::jmax((int)std::ceil(standardDeviation * 3.0f), boxRadii[0] + boxRadii[1] + boxRadii[2]);
+
+            //
+            // The pyramid reads whole low-resolution pixels, plus one more on each side for the bilinear upsample
+            //
+            if (auto scale = getPyramidScale(standardDeviation); scale > 1)
+                radius = juce::jmax(radius, ((int)std::ceil(getLowResolutionStandardDeviation(standardDeviation, scale) * 3.0f) + 2) * scale);
+
+            return radius;
+        }
+
+        /**
+         * Separable Gaussian blur.
+         *
+         * source must cover destination.area expanded by getBlurRadius(standardDeviation), except where hardEdge
+         * clips it. With hardEdge set, pixels outside that rectangle are treated as copies of the nearest edge pixel
+         * and the output is clipped to the rectangle; otherwise pixels outside the source are transparent.
+         */
+        template <typename Sample>
+        static void gaussianBlur(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, float standardDeviation, int optimization,
+            std::optional<juce::Rectangle<int>> hardEdge)
+        {
+            auto radius = getBlurRadius(standardDeviation);
+            if (radius == 0)
+            {
+                EffectKernels::copy(source, destination);
+                return;
+            }
+
+            if (!hardEdge && optimization != Effect::GaussianBlur::quality)
+            {
+                if (auto scale = getPyramidScale(standardDeviation); scale > 1)
+                {
+                    pyramidBlur(source, destination, standardDeviation, scale);
+                    return;
+                }
+            }
+
+            Filter const filter{ standardDeviation, optimization };
+            auto const& area = destination.area;
+            auto width = area.getWidth();
+
+            //
+            // Horizontal pass into an intermediate buffer with radius extra rows above and below
+            //
+            ImageBuffer<Sample> intermediate{ area.expanded(0, radius) };
+            parallelForRows(intermediate.area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<Sample> padded((size_t)(width + radius * 2));
+                    PooledVector<Sample> scratch;
+
+                    for (int y = intermediate.area.getY() + startRow; y < intermediate.area.getY() + endRow; ++y)
+                    {
+                        auto sourceY = hardEdge ? juce::jlimit(hardEdge->getY(), hardEdge->getBottom() - 1, y) : y;
+                        fetchRow(source, area.getX() - radius, sourceY, padded, hardEdge);
+
+                        filter.apply(Lines<Sample>{ padded.data(), 1 }, (int)padded.size(), 1, scratch);
+                        std::copy_n(padded.data() + radius, width, intermediate.getRow(y));
+                    }
+                });
+
+            //
+            // Vertical pass in place over strips of columns
+            //
+            auto numStrips = (width + columnsPerStrip - 1) / columnsPerStrip;
+            parallelFor(numStrips, [&](int strip)
+                {
+                    PooledVector<Sample> scratch;
+                    auto firstColumn = strip * columnsPerStrip;
+                    auto numColumns = juce::jmin(columnsPerStrip, width - firstColumn);
+
+                    filter.apply(Lines<Sample>{ intermediate.getRow(intermediate.area.getY()) + firstColumn, width },
+                        intermediate.area.getHeight(), numColumns, scratch);
+                });
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto output = destination.getRow(y);
+                        std::copy_n(intermediate.getRow(y), width, output);
+
+                        if (hardEdge)
+                            clearOutside(output, area.getX(), y, width, *hardEdge);
+                    }
+                });
+        }
+
+        /**
+         * Blurs the source alpha and fills destination with the shadow color scaled by the blurred alpha.
+         *
+         * Scaling by the color commutes with the blur, so blurring the single alpha channel first gives the same
+         * result as tinting every pixel and blurring all four channels.
+         */
+        static void shadow(AlphaBuffer const& source, PixelBuffer& destination, float standardDeviation, int optimization, Color128 premultipliedColor)
+        {
+            AlphaBuffer blurred{ destination.area };
+            gaussianBlur(source, blurred, standardDeviation, optimization, {});
+
+            auto color = Vec4::fromColor(premultipliedColor);
+            parallelForRows(destination.area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    auto width = (size_t)destination.area.getWidth();
+                    for (auto index = (size_t)startRow * width, end = (size_t)endRow * width; index < end; ++index)
+                        destination.pixels[index] = (color * Vec4{ blurred.pixels[index] }).toColor();
+                });
+        }
+
+        /**
+         * Shadow whose consumers only read alpha; the output alpha is the blurred source alpha scaled by the shadow alpha
+         */
+        static void shadow(AlphaBuffer const& source, AlphaBuffer& destination, float standardDeviation, int optimization, float premultipliedAlpha)
+        {
+            gaussianBlur(source, destination, standardDeviation, optimization, {});
+
+            for (auto& alpha : destination.pixels)
+                alpha *= premultipliedAlpha;
+        }
+
+        /**
+         * Integer division rounding toward negative infinity, so low-resolution pixels line up across zero
+         */
+        static int floorDivide(int value, int divisor) noexcept
+        {
+            return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+        }
+
+        /**
+         * Averages each scale x scale block of source into one destination pixel; pixels outside source are transparent
+         */
+        template <typename Sample>
+        static void downsample(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, int scale)
+        {
+            using Traits = SampleTraits<Sample>;
+            using Value = typename Traits::Value;
+
+            auto const& area = destination.area;
+            auto const normalize = Traits::splat(1.0f / (float)(scale * scale));
+
+            //
+            // The source columns each destination column averages, as offsets into a source row
+            //
+            std::vector<juce::Range<int>> columns((size_t)area.getWidth());
+            for (int x = 0; x < area.getWidth(); ++x)
+            {
+                auto start = juce::jmax((area.getX() + x) * scale, source.area.getX());
+                auto end = juce::jmin((area.getX() + x + 1) * scale, source.area.getRight());
+                columns[(size_t)x] = { start - source.area.getX(), juce::jmax(start, end) - source.area.getX() };
+            }
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<Value> sums((size_t)area.getWidth());
+
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        std::fill(sums.begin(), sums.end(), Value{});
+
+                        auto firstSourceY = juce::jmax(y * scale, source.area.getY());
+                        auto endSourceY = juce::jmin((y + 1) * scale, source.area.getBottom());
+                        for (int sourceY = firstSourceY; sourceY < endSourceY; ++sourceY)
+                        {
+                            auto sourceRow = source.getRow(sourceY);
+                            for (size_t x = 0; x < sums.size(); ++x)
+                            {
+                                Value sum{};
+                                for (auto sourceX = columns[x].getStart(); sourceX < columns[x].getEnd(); ++sourceX)
+                                    sum += Traits::load(sourceRow[sourceX]);
+
+                                sums[x] += sum;
+                            }
+                        }
+
+                        auto output = destination.getRow(y);
+                        for (int x = 0; x < area.getWidth(); ++x)
+                            output[x] = Traits::store(sums[(size_t)x] * normalize);
+                    }
+                });
+        }
+
+    private:
+        /**
+         * The largest power of two that keeps the low-resolution standard deviation at or above minimumPyramidStandardDeviation
+         */
+        static int getPyramidScale(float standardDeviation) noexcept
+        {
+            auto scale = 1;
+            while (scale < maximumPyramidScale && standardDeviation / (float)(scale * 2) >= minimumPyramidStandardDeviation)
+                scale *= 2;
+
+            return scale;
+        }
+
+        static float getLowResolutionStandardDeviation(float standardDeviation, int scale) noexcept
+        {
+            auto scaleSquared = (float)(scale * scale);
+            auto remainingVariance = standardDeviation * standardDeviation - (scaleSquared - 1.0f) / 12.0f - scaleSquared / 6.0f;
+            return std::sqrt(juce::jmax(remainingVariance, 0.0f)) / (float)scale;
+        }
+
+        template <typename Sample>
+        static void pyramidBlur(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, float standardDeviation, int scale)
+        {
+            //
+            // The scale x scale box average adds (scale^2 - 1) / 12 to the variance and the bilinear upsample adds about
+            // scale^2 / 6; blur the rest at low resolution. Low-resolution pixel i covers full-resolution pixels
+            // [i * scale, (i + 1) * scale), so results line up no matter which area is requested.
+            //
+            auto lowResolutionStandardDeviation = getLowResolutionStandardDeviation(standardDeviation, scale);
+
+            auto const& area = destination.area;
+            auto lowResolutionSourceArea = juce::Rectangle<int>::leftTopRightBottom(floorDivide(source.area.getX(), scale),
+                floorDivide(source.area.getY(), scale),
+                floorDivide(source.area.getRight() - 1, scale) + 1,
+                floorDivide(source.area.getBottom() - 1, scale) + 1);
+            auto lowResolutionArea = juce::Rectangle<int>::leftTopRightBottom(floorDivide(area.getX(), scale) - 1,
+                floorDivide(area.getY(), scale) - 1,
+                floorDivide(area.getRight() - 1, scale) + 2,
+                floorDivide(area.getBottom() - 1, scale) + 2);
+
+            ImageBuffer<Sample> downsampled{ lowResolutionSourceArea };
+            downsample(source, downsampled, scale);
+
+            ImageBuffer<Sample> blurred{ lowResolutionArea };
+            gaussianBlur(downsampled, blurred, lowResolutionStandardDeviation, Effect::GaussianBlur::quality, {});
+
+            upsample(blurred, destination, scale);
+        }
+
+        /**
+         * Bilinear interpolation from the low-resolution source; destination pixel centers map to
+         * (x + 0.5) / scale - 0.5 in source pixels
+         */
+        template <typename Sample>
+        static void upsample(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, int scale)
+        {
+            using Traits = SampleTraits<Sample>;
+
+            auto const& area = destination.area;
+            auto inverseScale = 1.0f / (float)scale;
+
+            auto getSourcePosition = [&](int position, int sourceStart, int& index, float& fraction)
+                {
+                    auto mapped = ((float)position + 0.5f) * inverseScale - 0.5f;
+                    auto whole = std::floor(mapped);
+                    index = (int)whole - sourceStart;
+                    fraction = mapped - whole;
+                };
+
+            std::vector<int> columns((size_t)area.getWidth());
+            std::vector<float> columnFractions((size_t)area.getWidth());
+            for (int x = 0; x < area.getWidth(); ++x)
+                getSourcePosition(area.getX() + x, source.area.getX(), columns[(size_t)x], columnFractions[(size_t)x]);
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<Sample> blendedRow((size_t)source.area.getWidth());
+
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        int row;
+                        float rowFraction;
+                        getSourcePosition(y, source.area.getY(), row, rowFraction);
+                        jassert(row >= 0 && row + 1 < source.area.getHeight());
+
+                        //
+                        // Interpolate vertically once per source column, then horizontally per destination pixel
+                        //
+                        auto upper = source.getRow(source.area.getY() + row);
+                        auto lower = source.getRow(source.area.getY() + row + 1);
+                        auto const lowerWeight = Traits::splat(rowFraction);
+                        for (size_t x = 0; x < blendedRow.size(); ++x)
+                            blendedRow[x] = Traits::store(Traits::lerp(Traits::load(upper[x]), Traits::load(lower[x]), lowerWeight));
+
+                        auto output = destination.getRow(y);
+                        for (int x = 0; x < area.getWidth(); ++x)
+                        {
+                            auto column = (size_t)columns[(size_t)x];
+                            output[x] = Traits::store(Traits::lerp(Traits::load(blendedRow[column]), Traits::load(blendedRow[column + 1]),
+                                Traits::splat(columnFractions[(size_t)x])));
+                        }
+                    }
+                });
+        }
+
+        /**
+         * A set of parallel lines of pixels; pixel i of line j is at base[i * stride + j]
+         */
+        template <typename Sample>
+        struct Lines
+        {
+            Sample* base;
+            int stride;
+
+            Sample& at(int index, int line) const noexcept
+            {
+                return base[(size_t)index * (size_t)stride + (size_t)line];
+            }
+        };
+
+        /**
+         * One-dimensional Gaussian filter. apply filters every line in place; pixels closer to either end of a line
+         * than the blur radius aren't valid afterwards.
+         */
+        struct Filter
+        {
+            Filter(float standardDeviation, int optimization)
+            {
+                if (standardDeviation < minimumApproximateStandardDeviation || optimization == Effect::GaussianBlur::quality)
+                {
+                    method = Method::exact;
+                    kernelRadius = (int)std::ceil(standardDeviation * 3.0f);
+
+                    auto sum = 0.0f;
+                    for (int offset = -kernelRadius; offset <= kernelRadius; ++offset)
+                    {
+                        auto weight = std::exp(-(float)(offset * offset) / (2.0f * standardDeviation * standardDeviation));
+                        weights.push_back(weight);
+                        sum += weight;
+                    }
+
+                    for (auto& weight : weights)
+                        weight /= sum;
+
+                    return;
+                }
+
+                if (optimization == Effect::GaussianBlur::speed)
+                {
+                    //
+                    // Young & van Vliet, "Recursive implementation of the Gaussian filter", Signal Processing 44 (1995)
+                    //
+                    method = Method::recursive;
+
+                    auto q = standardDeviation >= 2.5f ?
+                        0.98711f * standardDeviation - 0.96330f :
+                        3.97156f - 4.14554f * std::sqrt(1.0f - 0.26891f * standardDeviation);
+                    auto q2 = q * q, q3 = q2 * q;
+                    auto b0 = 1.57825f + 2.44413f * q + 1.4281f * q2 + 0.422205f * q3;
+                    auto b1 = 2.44413f * q + 2.85619f * q2 + 1.26661f * q3;
+                    auto b2 = -(1.4281f * q2 + 1.26661f * q3);
+                    auto b3 = 0.422205f * q3;
+
+                    feedback = { b1 / b0, b2 / b0, b3 / b0 };
+                    gain = 1.0f - feedback[0] - feedback[1] - feedback[2];
+                    return;
+                }
+
+                method = Method::box;
+                boxRadii = getBoxRadii(standardDeviation);
+            }
+
+            template <typename Sample>
+            void apply(Lines<Sample> lines, int length, int numLines, PooledVector<Sample>& scratch) const
+            {
+                switch (method)
+                {
+                case Method::exact: applyExact(lines, length, numLines, scratch); break;
+                case Method::box: applyBoxes(lines, length, numLines, scratch); break;
+                case Method::recursive: applyRecursive(lines, length, numLines); break;
+                }
+            }
+
+        private:
+            enum class Method
+            {
+                exact,
+                box,
+                recursive
+            } method = Method::exact;
+
+            int kernelRadius = 0;
+            std::vector<float> weights;
+            std::array<int, 3> boxRadii{};
+            std::array<float, 3> feedback{};
+            float gain = 1.0f;
+
+            template <typename Sample>
+            void applyExact(Lines<Sample> lines, int length, int numLines, PooledVector<Sample>& scratch) const
+            {
+                using Traits = SampleTraits<Sample>;
+
+                scratch.resize((size_t)length * (size_t)numLines);
+                Lines<Sample> input{ scratch.data(), numLines };
+                for (int index = 0; index < length; ++index)
+                    std::copy_n(&lines.at(index, 0), numLines, &input.at(index, 0));
+
+                for (int index = kernelRadius; index < length - kernelRadius; ++index)
+                {
+                    for (int line = 0; line < numLines; ++line)
+                    {
+                        typename Traits::Value sum{};
+                        for (size_t tap = 0; tap < weights.size(); ++tap)
+                            sum += Traits::load(input.at(index - kernelRadius + (int)tap, line)) * Traits::splat(weights[tap]);
+
+                        lines.at(index, line) = Traits::store(sum);
+                    }
+                }
+            }
+
+            template <typename Sample>
+            void applyBoxes(Lines<Sample> lines, int length, int numLines, PooledVector<Sample>& scratch) const
+            {
+                scratch.resize((size_t)length * (size_t)numLines);
+                Lines<Sample> other{ scratch.data(), numLines };
+                std::vector<typename SampleTraits<Sample>::Value> sums((size_t)numLines);
+
+                //
+                // Each pass narrows the valid part of the line by its radius
+                //
+                auto start = 0, end = length;
+                boxPass(lines, other, start, end, numLines, boxRadii[0], sums);
+                start += boxRadii[0], end -= boxRadii[0];
+                boxPass(other, lines, start, end, numLines, boxRadii[1], sums);
+                start += boxRadii[1], end -= boxRadii[1];
+                boxPass(lines, other, start, end, numLines, boxRadii[2], sums);
+                start += boxRadii[2], end -= boxRadii[2];
+
+                for (int index = start; index < end; ++index)
+                    std::copy_n(&other.at(index, 0), numLines, &lines.at(index, 0));
+            }
+
+            /**
+             * Averages each pixel with the radius pixels on either side, for output pixels in [start + radius, end - radius)
+             */
+            template <typename Sample, typename Value>
+            static void boxPass(Lines<Sample> input, Lines<Sample> output, int start, int end, int numLines, int radius, std::vector<Value>& sums)
+            {
+                using Traits = SampleTraits<Sample>;
+
+                if (end - start <= radius * 2)
+                    return;
+
+                auto const scale = Traits::splat(1.0f / (float)(radius * 2 + 1));
+
+                std::fill(sums.begin(), sums.end(), Value{});
+                for (int index = start; index <= start + radius * 2; ++index)
+                {
+                    for (int line = 0; line < numLines; ++line)
+                        sums[(size_t)line] += Traits::load(input.at(index, line));
+                }
+
+                for (int index = start + radius; index < end - radius; ++index)
+                {
+                    auto entering = index + radius + 1;
+                    auto leaving = index - radius;
+
+                    for (int line = 0; line < numLines; ++line)
+                    {
+                        auto& sum = sums[(size_t)line];
+                        output.at(index, line) = Traits::store(sum * scale);
+
+                        if (entering < end)
+                            sum += Traits::load(input.at(entering, line)) - Traits::load(input.at(leaving, line));
+                    }
+                }
+            }
+
+            template <typename Sample>
+            void applyRecursive(Lines<Sample> lines, int length, int numLines) const
+            {
+                using Traits = SampleTraits<Sample>;
+
+                auto const b = Traits::splat(gain), a1 = Traits::splat(feedback[0]), a2 = Traits::splat(feedback[1]), a3 = Traits::splat(feedback[2]);
+                std::vector<typename Traits::Value> state((size_t)numLines * 3);
+
+                //
+                // Causal pass, starting from the steady state for the first pixel
+                //
+                for (int line = 0; line < numLines; ++line)
+                    std::fill_n(state.begin() + line * 3, 3, Traits::load(lines.at(0, line)));
+
+                for (int index = 0; index < length; ++index)
+                {
+                    for (int line = 0; line < numLines; ++line)
+                    {
+                        auto history = state.data() + line * 3;
+                        auto value = b * Traits::load(lines.at(index, line)) + a1 * history[0] + a2 * history[1] + a3 * history[2];
+                        history[2] = history[1];
+                        history[1] = history[0];
+                        history[0] = value;
+                        lines.at(index, line) = Traits::store(value);
+                    }
+                }
+
+                //
+                // Anti-causal pass
+                //
+                for (int line = 0; line < numLines; ++line)
+                    std::fill_n(state.begin() + line * 3, 3, Traits::load(lines.at(length - 1, line)));
+
+                for (int index = length; index-- > 0;)
+                {
+                    for (int line = 0; line < numLines; ++line)
+                    {
+                        auto history = state.data() + line * 3;
+                        auto value = b * Traits::load(lines.at(index, line)) + a1 * history[0] + a2 * history[1] + a3 * history[2];
+                        history[2] = history[1];
+                        history[1] = history[0];
+                        history[0] = value;
+                        lines.at(index, line) = Traits::store(value);
+                    }
+                }
+            }
+        };
+
+        /**
+         * Radii for three box blurs whose combined variance is closest to the Gaussian's
+         */
+        static std::array<int, 3> getBoxRadii(float standardDeviation) noexcept
+        {
+            auto variance = standardDeviation * standardDeviation;
+            auto idealWidth = std::sqrt(4.0f * variance + 1.0f);
+            auto lowerWidth = (int)std::floor(idealWidth);
+            if (lowerWidth % 2 == 0)
+                --lowerWidth;
+
+            auto numLower = (int)std::round((12.0f * variance - 3.0f * (float)(lowerWidth * lowerWidth) - 12.0f * (float)lowerWidth - 9.0f)
+                / (-4.0f * (float)lowerWidth - 4.0f));
+            numLower = juce::jlimit(0, 3, numLower);
+
+            std::array<int, 3> radii{};
+            for (int index = 0; index < 3; ++index)
+                radii[(size_t)index] = ((index < numLower ? lowerWidth : lowerWidth + 2) - 1) / 2;
+
+            return radii;
+        }
+
+        /**
+         * Fills row with the pixels from source starting at (startX, y). Pixels outside the source are transparent,
+         * or with hardEdge set, copies of the nearest pixel inside hardEdge.
+         */
+        template <typename Sample>
+        static void fetchRow(ImageBuffer<Sample> const& source, int startX, int y, std::vector<Sample>& row, std::optional<juce::Rectangle<int>> hardEdge)
+        {
+            auto endX = startX + (int)row.size();
+            std::fill(row.begin(), row.end(), Sample{});
+
+            if (y < source.area.getY() || y >= source.area.getBottom())
+                return;
+
+            auto sourceRow = source.getRow(y);
+            auto overlapStart = juce::jmax(startX, source.area.getX());
+            auto overlapEnd = juce::jmin(endX, source.area.getRight());
+            if (overlapStart < overlapEnd)
+                std::copy(sourceRow + (overlapStart - source.area.getX()), sourceRow + (overlapEnd - source.area.getX()), row.begin() + (overlapStart - startX));
+
+            if (!hardEdge || overlapStart >= overlapEnd)
+                return;
+
+            auto edgeStart = juce::jmax(overlapStart, hardEdge->getX());
+            auto edgeEnd = juce::jmin(overlapEnd, hardEdge->getRight());
+            if (edgeStart >= edgeEnd)
+                return;
+
+            std::fill(row.begin(), row.begin() + (edgeStart - startX), sourceRow[edgeStart - source.area.getX()]);
+            std::fill(row.begin() + (edgeEnd - startX), row.end(), sourceRow[edgeEnd - 1 - source.area.getX()]);
+        }
+
+        template <typename Sample>
+        static void clearOutside(Sample* row, int startX, int y, int width, juce::Rectangle<int> bounds)
+        {
+            if (y < bounds.getY() || y >= bounds.getBottom())
+            {
+                std::fill(row, row + width, Sample{});
+                return;
+            }
+
+            auto insideStart = juce::jlimit(0, width, bounds.getX() - startX);
+            auto insideEnd = juce::jlimit(insideStart, width, bounds.getRight() - startX);
+            std::fill(row, row + insideStart, Sample{});
+            std::fill(row + insideEnd, row + width, Sample{});
+        }
+    };
+
+} // namespace mescal::software
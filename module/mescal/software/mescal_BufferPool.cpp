@@ -0,0 +1,305 @@
+namespace mescal::software
+{
+    /*
+
+        Size-class pool for image buffer memory
+
+        Every intermediate buffer the software renderers use is an ImageBuffer, and every ImageBuffer gets its memory
+        from here. Requests are rounded up to one of four size classes per power of two (so no more than a quarter
+        of a block is ever wasted), and a released block goes onto the free list for its class instead of back to
+        the heap. The next request in the same class, whether it comes from a later node in the same render or from
+        the next applyEffect call, takes that block without a trip through the system allocator or any fresh page
+        faults.
+
+        Small requests are cheap to serve from the heap, so anything under minimumPooledBytes skips the pool. The
+        pool keeps no more free memory than the largest working set (the peak pooled memory in use) of the last
+        numRecentRenders renders, and never more than the retain limit. When a release would go over that, blocks
+        from the size classes that have gone longest without being asked for go back to the heap first, so buffers
+        left over from a graph that's no longer drawn don't crowd out the ones the current graph keeps reusing.
+        After one very large render, the free memory it leaves behind is handed back once a few smaller renders
+        have shown it isn't needed any more.
+
+    */
+    struct BufferPool
+    {
+        static constexpr size_t minimumPooledBytes = 64 * 1024;
+        static constexpr size_t defaultRetainLimit = 64 * 1024 * 1024;
+        static constexpr int numRecentRenders = 8;
+        static constexpr int classesPerOctave = 4;
+
+        /**
+         * The one pool shared by every renderer. It's never destroyed, so buffers held in static objects can
+         * still be released safely at shutdown.
+         */
+        static BufferPool& getInstance()
+        {
+            static auto pool = new BufferPool;
+            return *pool;
+        }
+
+        void* allocate(size_t numBytes)
+        {
+            if (numBytes < minimumPooledBytes)
+                return ::operator new(numBytes);
+
+            auto sizeClass = getSizeClass(numBytes);
+
+            {
+                std::lock_guard<std::mutex> lock{ mutex };
+                inUseBytes += sizeClass.numBytes;
+                peakInUseBytes = juce::jmax(peakInUseBytes, inUseBytes);
+
+                auto& freeList = freeLists[sizeClass.index];
+                freeList.lastUsed = ++clock;
+
+                if (!freeList.blocks.empty())
+                {
+                    auto block = freeList.blocks.back();
+                    freeList.blocks.pop_back();
+                    retainedBytes -= sizeClass.numBytes;
+                    return block;
+                }
+            }
+
+            return ::operator new(sizeClass.numBytes);
+        }
+
+        /**
+         * numBytes must be the size that was passed to allocate
+         */
+        void release(void* block, size_t numBytes) noexcept
+        {
+            if (numBytes < minimumPooledBytes)
+            {
+                ::operator delete(block);
+                return;
+            }
+
+            auto sizeClass = getSizeClass(numBytes);
+            std::vector<void*> evicted;
+
+            {
+                std::lock_guard<std::mutex> lock{ mutex };
+                inUseBytes -= sizeClass.numBytes;
+
+                auto& blocks = freeLists[sizeClass.index].blocks;
+                auto limit = getLimit();
+                if (sizeClass.numBytes > limit || !(blocks.size() < blocks.capacity() || reserveSlot(blocks)))
+                {
+                    evicted.push_back(block);
+                }
+                else
+                {
+                    while (retainedBytes + sizeClass.numBytes > limit)
+                        evictLeastRecentlyUsed(evicted);
+
+                    blocks.push_back(block);
+                    retainedBytes += sizeClass.numBytes;
+                }
+            }
+
+            for (auto evictedBlock : evicted)
+                ::operator delete(evictedBlock);
+        }
+
+        /**
+         * Called at the end of each render; records its working set and returns free blocks that recent renders
+         * haven't needed to the heap
+         */
+        void endRender() noexcept
+        {
+            std::vector<void*> evicted;
+
+            {
+                std::lock_guard<std::mutex> lock{ mutex };
+                recentWorkingSets[nextRecentRender] = peakInUseBytes;
+                nextRecentRender = (nextRecentRender + 1) % recentWorkingSets.size();
+                peakInUseBytes = inUseBytes;
+
+                shrinkTo(getLimit(), evicted);
+            }
+
+            for (auto evictedBlock : evicted)
+                ::operator delete(evictedBlock);
+        }
+
+        /**
+         * Caps the free memory the pool keeps, however large recent renders were
+         */
+        void setRetainLimit(size_t numBytes) noexcept
+        {
+            std::vector<void*> evicted;
+
+            {
+                std::lock_guard<std::mutex> lock{ mutex };
+                retainLimit = numBytes;
+                shrinkTo(getLimit(), evicted);
+            }
+
+            for (auto evictedBlock : evicted)
+                ::operator delete(evictedBlock);
+        }
+
+        /**
+         * Returns every free block to the heap
+         */
+        void trim() noexcept
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            for (auto& freeList : freeLists)
+            {
+                for (auto block : freeList.blocks)
+                    ::operator delete(block);
+
+                freeList.blocks.clear();
+            }
+
+            retainedBytes = 0;
+        }
+
+        size_t getRetainedBytes() const noexcept
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            return retainedBytes;
+        }
+
+    private:
+        struct SizeClass
+        {
+            size_t index;
+            size_t numBytes;
+        };
+
+        struct FreeList
+        {
+            std::vector<void*> blocks;
+            uint64_t lastUsed = 0;
+        };
+
+        static constexpr int minimumOctave = 15;
+        static constexpr int numOctaves = 64 - minimumOctave;
+
+        /**
+         * numBytes lies in (2^octave, 2^(octave + 1)]; the classes split that range into equal steps
+         */
+        static SizeClass getSizeClass(size_t numBytes) noexcept
+        {
+            int octave = 0;
+            while ((numBytes - 1) >> (octave + 1))
+                ++octave;
+
+            auto base = (size_t)1 << octave;
+            auto step = base / classesPerOctave;
+            auto stepIndex = (numBytes - base + step - 1) / step;
+
+            return { (size_t)(octave - minimumOctave) * classesPerOctave + stepIndex - 1, base + stepIndex * step };
+        }
+
+        static size_t getClassSize(size_t index) noexcept
+        {
+            auto base = (size_t)1 << (index / classesPerOctave + minimumOctave);
+            return base + (index % classesPerOctave + 1) * (base / classesPerOctave);
+        }
+
+        /**
+         * The most free memory to keep: the largest recent working set, up to the retain limit
+         */
+        size_t getLimit() const noexcept
+        {
+            auto workingSet = juce::jmax(peakInUseBytes, *std::max_element(recentWorkingSets.begin(), recentWorkingSets.end()));
+            return juce::jmin(retainLimit, workingSet);
+        }
+
+        void shrinkTo(size_t limit, std::vector<void*>& evicted)
+        {
+            while (retainedBytes > limit)
+                evictLeastRecentlyUsed(evicted);
+        }
+
+        /**
+         * Takes one block from the non-empty size class that was last asked for longest ago; the caller frees
+         * it once the lock is released
+         */
+        void evictLeastRecentlyUsed(std::vector<void*>& evicted)
+        {
+            FreeList* oldest = nullptr;
+            size_t oldestIndex = 0;
+            for (size_t index = 0; index < freeLists.size(); ++index)
+            {
+                auto& freeList = freeLists[index];
+                if (!freeList.blocks.empty() && (!oldest || freeList.lastUsed < oldest->lastUsed))
+                {
+                    oldest = &freeList;
+                    oldestIndex = index;
+                }
+            }
+
+            jassert(oldest);
+            evicted.push_back(oldest->blocks.back());
+            oldest->blocks.pop_back();
+            retainedBytes -= getClassSize(oldestIndex);
+        }
+
+        static bool reserveSlot(std::vector<void*>& blocks) noexcept
+        {
+            try
+            {
+                blocks.reserve(juce::jmax((size_t)8, blocks.capacity() * 2));
+                return true;
+            }
+            catch (...)
+            {
+                return false;
+            }
+        }
+
+        mutable std::mutex mutex;
+        std::array<FreeList, (size_t)numOctaves * classesPerOctave> freeLists;
+        size_t retainedBytes = 0;
+        size_t retainLimit = defaultRetainLimit;
+        size_t inUseBytes = 0;
+        size_t peakInUseBytes = 0;
+        std::array<size_t, numRecentRenders> recentWorkingSets{};
+        size_t nextRecentRender = 0;
+        uint64_t clock = 0;
+    };
+
+    /**
+     * Standard allocator that serves memory from the BufferPool
+     */
+    template <typename T>
+    struct PoolAllocator
+    {
+        using value_type = T;
+
+        PoolAllocator() noexcept = default;
+
+        template <typename Other>
+        PoolAllocator(PoolAllocator<Other> const&) noexcept
+        {
+        }
+
+        T* allocate(size_t count)
+        {
+            return static_cast<T*>(BufferPool::getInstance().allocate(count * sizeof(T)));
+        }
+
+        void deallocate(T* pointer, size_t count) noexcept
+        {
+            BufferPool::getInstance().release(pointer, count * sizeof(T));
+        }
+
+        template <typename Other>
+        bool operator== (PoolAllocator<Other> const&) const noexcept { return true; }
+
+        template <typename Other>
+        bool operator!= (PoolAllocator<Other> const&) const noexcept { return false; }
+    };
+
+    /**
+     * For scratch buffers inside kernels that are big enough to be worth recycling
+     */
+    template <typename T>
+    using PooledVector = std::vector<T, PoolAllocator<T>>;
+
+} // namespace mescal::software
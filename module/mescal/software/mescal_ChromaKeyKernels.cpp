@@ -0,0 +1,182 @@
+namespace mescal::software
+{
+    /*
+
+        Chroma key kernel for the software effect renderer
+
+        Each pixel's straight color is compared with the key color, and pixels within the tolerance become
+        transparent. With feathering, alpha ramps up through a smoothstep centered on the tolerance instead of
+        switching off at a hard edge.
+
+        chromaKeyRow works on eight pixels per step. Each group of four pixels is transposed into one Vec4 per
+        channel, so the distances for four pixels come out of a single run of vector arithmetic. Green-screen
+        captures are mostly either key color or foreground well away from it; a group where every pixel is kept
+        unchanged (or is already transparent) isn't transposed back or written.
+
+        Chroma key is point-wise, so it also runs one row at a time inside a FusedEffectKernel.
+
+    */
+    struct ChromaKeyKernels
+    {
+        static constexpr int pixelsPerStep = 8;
+
+        enum class Metric
+        {
+            rgb,    // Euclidean distance in RGB, scaled so black to white is 1
+            yCbCr   // Distance in the CbCr plane with luma counting for a quarter; less sensitive to shading on the screen
+        };
+
+        struct Key
+        {
+            Vector3 color{};
+            float tolerance = 0.1f;
+            bool invertAlpha = false;
+            bool feather = false;
+            Metric metric = Metric::rgb;
+        };
+
+        /**
+         * Keys the buffer in place
+         */
+        static void chromaKey(PixelBuffer& buffer, Key const& key)
+        {
+            auto width = buffer.area.getWidth();
+            parallelForRows(buffer.area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int row = startRow; row < endRow; ++row)
+                        chromaKeyRow(buffer.pixels.data() + (size_t)row * (size_t)width, width, key);
+                });
+        }
+
+        static void chromaKeyRow(Color128* row, int width, Key const& key) noexcept
+        {
+            if (key.metric == Metric::yCbCr)
+                keyRow<Metric::yCbCr>(row, width, key);
+            else
+                keyRow<Metric::rgb>(row, width, key);
+        }
+
+    private:
+        /**
+         * Maps a color difference into the space the distance is measured in
+         */
+        template <Metric metric>
+        static std::array<Vec4, 3> toMetricSpace(Vec4 red, Vec4 green, Vec4 blue) noexcept
+        {
+            if constexpr (metric == Metric::yCbCr)
+            {
+                //
+                // BT.601 with luma at half scale, so its squared distance counts for a quarter
+                //
+                auto luma = Vec4{ 0.299f } * red + Vec4{ 0.587f } * green + Vec4{ 0.114f } * blue;
+                return { luma * Vec4{ 0.5f }, (blue - luma) * Vec4{ 0.564f }, (red - luma) * Vec4{ 0.713f } };
+            }
+            else
+            {
+                Vec4 const scale{ 0.57735027f };
+                return { red * scale, green * scale, blue * scale };
+            }
+        }
+
+        /**
+         * Per-row constants; keep is 1 for pixels that stay and 0 for pixels that are keyed out
+         */
+        template <Metric metric>
+        struct Parameters
+        {
+            explicit Parameters(Key const& key) :
+                keyColor(toMetricSpace<metric>(Vec4{ key.color[0] }, Vec4{ key.color[1] }, Vec4{ key.color[2] })),
+                invert(key.invertAlpha),
+                feather(key.feather)
+            {
+                auto tolerance = juce::jmax(key.tolerance, 0.0f);
+                toleranceSquared = Vec4{ tolerance * tolerance };
+
+                auto halfWidth = juce::jmax(tolerance * 0.5f, 1.0f / 255.0f);
+                featherStart = Vec4{ juce::jmax(tolerance - halfWidth, 0.0f) };
+                featherScale = Vec4{ 1.0f / (tolerance + halfWidth - juce::jmax(tolerance - halfWidth, 0.0f)) };
+            }
+
+            Vec4 getKeep(Vec4 red, Vec4 green, Vec4 blue, Vec4 alpha) const noexcept
+            {
+                Vec4 const one{ 1.0f }, tiny{ 1.0e-6f };
+
+                auto reciprocalAlpha = one / Vec4::max(alpha, tiny);
+                auto color = toMetricSpace<metric>(red * reciprocalAlpha, green * reciprocalAlpha, blue * reciprocalAlpha);
+                auto delta0 = color[0] - keyColor[0];
+                auto delta1 = color[1] - keyColor[1];
+                auto delta2 = color[2] - keyColor[2];
+                auto distanceSquared = delta0 * delta0 + delta1 * delta1 + delta2 * delta2;
+
+                Vec4 keep;
+                if (feather)
+                {
+                    auto t = Vec4::clamp((Vec4::sqrt(distanceSquared) - featherStart) * featherScale, 0.0f, 1.0f);
+                    keep = t * t * (Vec4{ 3.0f } - Vec4{ 2.0f } * t);
+                }
+                else
+                {
+                    keep = Vec4::select(Vec4::lessThan(distanceSquared, toleranceSquared), Vec4{}, one);
+                }
+
+                return invert ? one - keep : keep;
+            }
+
+            std::array<Vec4, 3> keyColor;
+            Vec4 toleranceSquared, featherStart, featherScale;
+            bool invert, feather;
+        };
+
+        /**
+         * Keys four pixels in place
+         */
+        template <Metric metric>
+        static void keyGroup(Color128* pixels, Parameters<metric> const& parameters) noexcept
+        {
+            auto red = Vec4::fromColor(pixels[0]);
+            auto green = Vec4::fromColor(pixels[1]);
+            auto blue = Vec4::fromColor(pixels[2]);
+            auto alpha = Vec4::fromColor(pixels[3]);
+            Vec4::transpose(red, green, blue, alpha);
+
+            auto keep = parameters.getKeep(red, green, blue, alpha);
+            auto removedAlpha = alpha * (Vec4{ 1.0f } - keep);
+            if (Vec4::allTrue(Vec4::lessThan(removedAlpha, Vec4{ 1.0e-7f })))
+                return;
+
+            red *= keep;
+            green *= keep;
+            blue *= keep;
+            alpha *= keep;
+            Vec4::transpose(red, green, blue, alpha);
+
+            pixels[0] = red.toColor();
+            pixels[1] = green.toColor();
+            pixels[2] = blue.toColor();
+            pixels[3] = alpha.toColor();
+        }
+
+        template <Metric metric>
+        static void keyRow(Color128* row, int width, Key const& key) noexcept
+        {
+            Parameters<metric> const parameters{ key };
+
+            int column = 0;
+            for (; column + pixelsPerStep <= width; column += pixelsPerStep)
+            {
+                keyGroup(row + column, parameters);
+                keyGroup(row + column + 4, parameters);
+            }
+
+            if (column < width)
+            {
+                std::array<Color128, pixelsPerStep> tail;
+                std::copy(row + column, row + width, tail.begin());
+                keyGroup(tail.data(), parameters);
+                keyGroup(tail.data() + 4, parameters);
+                std::copy_n(tail.begin(), width - column, row + column);
+            }
+        }
+    };
+
+} // namespace mescal::software
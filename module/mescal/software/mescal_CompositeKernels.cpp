@@ -0,0 +1,231 @@
+namespace mescal::software
+{
+    /*
+
+        Porter-Duff composite kernels for the software effect renderer
+
+        Like the blend kernels, each Effect::Composite mode gets its own instantiation of compositeRow, and
+        getRowFunction picks the instantiation once per call.
+
+        Composite inputs are usually mostly empty space (a shadow under a small shape, a highlight over part of a
+        control), so each row is split into spans. Wherever the source is fully transparent, the destination is
+        fully transparent, or the source is fully opaque, most modes reduce to keeping the destination, copying the
+        source, or clearing; only the remaining spans run the per-pixel formula. These shortcuts assume premultiplied
+        pixels, where a pixel with zero alpha has zero color as well.
+
+    */
+    struct CompositeKernels
+    {
+        using RowFunction = void (*)(Color128* destination, Color128 const* source, int width) noexcept;
+
+        static constexpr int numModes = Effect::Composite::maskInvert + 1;
+
+        /**
+         * Porter-Duff compositing; input 0 is the destination and input 1 is the source. The destination buffer
+         * receives the result. Pixels outside the source buffer are transparent, so the source only needs to cover
+         * the part of the destination where it has any pixels. sourceBounds is only used for Composite::boundedSourceCopy.
+         */
+        static void composite(PixelBuffer& destination, PixelBuffer const& source, int mode, juce::Rectangle<int> sourceBounds)
+        {
+            if (mode == Effect::Composite::boundedSourceCopy)
+            {
+                auto copyArea = sourceBounds.getIntersection(destination.area);
+                PixelBuffer sourceInBounds{ copyArea };
+                EffectKernels::copy(source, sourceInBounds);
+                EffectKernels::copy(sourceInBounds, destination);
+                return;
+            }
+
+            auto compositeRow = getRowFunction(mode);
+            auto const& area = destination.area;
+            auto sourceArea = source.area.getIntersection(area);
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto row = destination.getRow(y);
+                        if (y < sourceArea.getY() || y >= sourceArea.getBottom())
+                        {
+                            compositeRow(row, nullptr, area.getWidth());
+                            continue;
+                        }
+
+                        auto start = sourceArea.getX() - area.getX();
+                        auto end = sourceArea.getRight() - area.getX();
+                        compositeRow(row, nullptr, start);
+                        compositeRow(row + start, source.getRow(y) + (sourceArea.getX() - source.area.getX()), end - start);
+                        compositeRow(row + end, nullptr, area.getWidth() - end);
+                    }
+                });
+        }
+
+        /**
+         * The row kernel for a composite mode; unknown modes use source over. Composite::boundedSourceCopy depends
+         * on the source bounds, so it isn't handled here.
+         */
+        static RowFunction getRowFunction(int mode) noexcept
+        {
+            static auto const table = makeTable(std::make_integer_sequence<int, numModes>{});
+
+            jassert(mode != Effect::Composite::boundedSourceCopy);
+            if (mode < 0 || mode >= numModes)
+                return compositeRow<Effect::Composite::sourceOver>;
+
+            return table[(size_t)mode];
+        }
+
+        /**
+         * Composites a row of source pixels onto a row of destination pixels; a null source is a fully transparent row
+         */
+        template <int mode>
+        static void compositeRow(Color128* destination, Color128 const* source, int width) noexcept
+        {
+            if (!source)
+            {
+                runSpan<mode>(getSpanActions(mode).transparentSource, destination, nullptr, width);
+                return;
+            }
+
+            for (int start = 0; start < width;)
+            {
+                auto action = getAction<mode>(destination[start], source[start]);
+                auto end = start + 1;
+                while (end < width && getAction<mode>(destination[end], source[end]) == action)
+                    ++end;
+
+                runSpan<mode>(action, destination + start, source + start, end - start);
+                start = end;
+            }
+        }
+
+        template <int mode>
+        static Vec4 compositePixel(Vec4 destination, Vec4 source) noexcept
+        {
+            Vec4 const one{ 1.0f };
+            auto sourceAlpha = source.broadcast(3);
+            auto destinationAlpha = destination.broadcast(3);
+
+            if constexpr (mode == Effect::Composite::destinationOver) return source * (one - destinationAlpha) + destination;
+            else if constexpr (mode == Effect::Composite::sourceIn) return source * destinationAlpha;
+            else if constexpr (mode == Effect::Composite::destinationIn) return destination * sourceAlpha;
+            else if constexpr (mode == Effect::Composite::sourceOut) return source * (one - destinationAlpha);
+            else if constexpr (mode == Effect::Composite::destinationOut) return destination * (one - sourceAlpha);
+            else if constexpr (mode == Effect::Composite::sourceAtop) return source * destinationAlpha + destination * (one - sourceAlpha);
+            else if constexpr (mode == Effect::Composite::destinationAtop) return source * (one - destinationAlpha) + destination * sourceAlpha;
+            else if constexpr (mode == Effect::Composite::exclusiveOr) return source * (one - destinationAlpha) + destination * (one - sourceAlpha);
+            else if constexpr (mode == Effect::Composite::plus) return Vec4::min(source + destination, one);
+            else if constexpr (mode == Effect::Composite::sourceCopy) return source;
+            else if constexpr (mode == Effect::Composite::maskInvert)
+            {
+                //
+                // Invert the destination colors wherever the source is opaque
+                //
+                auto inverted = (destinationAlpha - destination) * sourceAlpha + destination * (one - sourceAlpha);
+                return Vec4::select(EffectKernels::getColorLanes(), inverted, destination);
+            }
+            else
+            {
+                return source + destination * (one - sourceAlpha);
+            }
+        }
+
+    private:
+        enum class SpanAction
+        {
+            compute,
+            keepDestination,
+            copySource,
+            clear
+        };
+
+        /**
+         * What each mode reduces to where the source is transparent, where the destination is transparent, and
+         * where the source is opaque
+         */
+        struct SpanActions
+        {
+            SpanAction transparentSource;
+            SpanAction transparentDestination;
+            SpanAction opaqueSource;
+        };
+
+        static constexpr SpanActions getSpanActions(int mode) noexcept
+        {
+            using Action = SpanAction;
+
+            switch (mode)
+            {
+            case Effect::Composite::destinationOver: return { Action::keepDestination, Action::copySource, Action::compute };
+            case Effect::Composite::sourceIn: return { Action::clear, Action::clear, Action::compute };
+            case Effect::Composite::destinationIn: return { Action::clear, Action::clear, Action::keepDestination };
+            case Effect::Composite::sourceOut: return { Action::clear, Action::copySource, Action::compute };
+            case Effect::Composite::destinationOut: return { Action::keepDestination, Action::clear, Action::clear };
+            case Effect::Composite::sourceAtop: return { Action::keepDestination, Action::clear, Action::compute };
+            case Effect::Composite::destinationAtop: return { Action::clear, Action::copySource, Action::compute };
+            case Effect::Composite::exclusiveOr: return { Action::keepDestination, Action::copySource, Action::compute };
+            case Effect::Composite::plus: return { Action::keepDestination, Action::copySource, Action::compute };
+            case Effect::Composite::sourceCopy: return { Action::clear, Action::copySource, Action::copySource };
+            case Effect::Composite::maskInvert: return { Action::keepDestination, Action::keepDestination, Action::compute };
+            default: return { Action::keepDestination, Action::copySource, Action::copySource };
+            }
+        }
+
+        template <int mode>
+        static SpanAction getAction(Color128 const& destination, Color128 const& source) noexcept
+        {
+            constexpr auto actions = getSpanActions(mode);
+
+            if (source.alpha <= 0.0f)
+                return actions.transparentSource;
+
+            if (destination.alpha <= 0.0f)
+                return actions.transparentDestination;
+
+            if (source.alpha >= 1.0f)
+                return actions.opaqueSource;
+
+            return SpanAction::compute;
+        }
+
+        template <int mode>
+        static void runSpan(SpanAction action, Color128* destination, Color128 const* source, int width) noexcept
+        {
+            switch (action)
+            {
+            case SpanAction::keepDestination:
+                break;
+
+            case SpanAction::copySource:
+                if (source)
+                    std::memcpy(destination, source, sizeof(Color128) * (size_t)width);
+                else
+                    std::memset(destination, 0, sizeof(Color128) * (size_t)width);
+                break;
+
+            case SpanAction::clear:
+                std::memset(destination, 0, sizeof(Color128) * (size_t)width);
+                break;
+
+            case SpanAction::compute:
+                if (!source)
+                {
+                    for (int column = 0; column < width; ++column)
+                        destination[column] = compositePixel<mode>(Vec4::fromColor(destination[column]), Vec4{}).toColor();
+                    break;
+                }
+
+                for (int column = 0; column < width; ++column)
+                    destination[column] = compositePixel<mode>(Vec4::fromColor(destination[column]), Vec4::fromColor(source[column])).toColor();
+                break;
+            }
+        }
+
+        template <int... modes>
+        static constexpr std::array<RowFunction, sizeof...(modes)> makeTable(std::integer_sequence<int, modes...>) noexcept
+        {
+            return { compositeRow<modes>... };
+        }
+    };
+
+} // namespace mescal::software
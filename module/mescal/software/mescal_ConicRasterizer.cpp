@@ -0,0 +1,160 @@
+namespace mescal::software
+{
+    /*
+
+        Software renderer for conic gradients
+
+        Rather than approximating each arc segment with a Bezier patch, this evaluates the gradient directly: every pixel
+        center is mapped back into gradient space, and its angle and radius pick the color. The result is exact at any
+        radius, however large.
+
+        Colors along the arc come from a pair of lookup tables, one for the inner radius and one for the outer radius,
+        each holding lookupTableSize premultiplied colors spaced evenly around the full circle. The tables are rebuilt only
+        when the stops change. Per pixel, the angle selects and linearly interpolates two adjacent table entries for each
+        radius, and the radial position blends between the inner and outer results.
+
+        Angles and radii are computed four pixels at a time with Vec4. Rows are split into bands that are rendered in
+        parallel.
+
+    */
+    struct ConicRasterizer
+    {
+        static constexpr int lookupTableSize = 4096;
+        static constexpr int rowsPerBand = 32;
+
+        /**
+         * Rebuilds the lookup tables from the stops. Segments between consecutive stops are layered in order, just as
+         * the Direct2D renderer draws one patch per segment; angles outside the range covered by the stops are transparent.
+         */
+        void buildLookupTables(std::vector<ConicGradient::Stop> const& stops)
+        {
+            innerColors.assign(lookupTableSize + 1, Color128{});
+            outerColors.assign(lookupTableSize + 1, Color128{});
+
+            constexpr auto twoPi = juce::MathConstants<float>::twoPi;
+            constexpr auto entriesPerRadian = (float)lookupTableSize / twoPi;
+
+            for (size_t index = 0; index + 1 < stops.size(); ++index)
+            {
+                auto const& stop = stops[index];
+                auto const& nextStop = stops[index + 1];
+                auto arcAngle = nextStop.angle - stop.angle;
+                auto innerStart = premultiplied(stop.innerColor), innerEnd = premultiplied(nextStop.innerColor);
+                auto outerStart = premultiplied(stop.outerColor), outerEnd = premultiplied(nextStop.outerColor);
+
+                auto lowestAngle = juce::jmin(stop.angle, nextStop.angle);
+                auto highestAngle = juce::jmax(stop.angle, nextStop.angle);
+
+                //
+                // Each segment covers [lowestAngle, highestAngle) so the entries at shared stops and at the 0/2 pi seam
+                // are composited once
+                //
+                auto firstEntry = (int64_t)std::ceil(lowestAngle * entriesPerRadian);
+                auto lastEntry = (int64_t)std::ceil(highestAngle * entriesPerRadian) - 1;
+
+                for (auto entry = firstEntry; entry <= lastEntry; ++entry)
+                {
+                    auto angle = (float)entry / entriesPerRadian;
+                    auto proportion = arcAngle != 0.0f ? Vec4{ (angle - stop.angle) / arcAngle } : Vec4{ 0.0f };
+                    auto tableIndex = (size_t)(((entry % lookupTableSize) + lookupTableSize) % lookupTableSize);
+
+                    compositeOver(innerColors[tableIndex], Vec4::lerp(Vec4::fromColor(innerStart), Vec4::fromColor(innerEnd), proportion));
+                    compositeOver(outerColors[tableIndex], Vec4::lerp(Vec4::fromColor(outerStart), Vec4::fromColor(outerEnd), proportion));
+                }
+            }
+
+            //
+            // The extra entry at the end lets the renderer interpolate across 2 pi without wrapping the index
+            //
+            innerColors[lookupTableSize] = innerColors[0];
+            outerColors[lookupTableSize] = outerColors[0];
+        }
+
+        void render(juce::Image::BitmapData& destination, juce::AffineTransform transform, juce::Range<float> radiusRange, Color128 backgroundColor) const
+        {
+            auto width = destination.width;
+            auto height = destination.height;
+            if (width <= 0 || height <= 0 || innerColors.size() != lookupTableSize + 1)
+                return;
+
+            //
+            // Edges are antialiased over one pixel; pixelScale converts gradient units to pixels
+            //
+            auto inverse = transform.inverted();
+            auto pixelScale = std::sqrt(std::abs(transform.mat00 * transform.mat11 - transform.mat01 * transform.mat10));
+            auto innerRadius = radiusRange.getStart();
+            auto outerRadius = radiusRange.getEnd();
+            auto inverseRadialLength = radiusRange.getLength() > 0.0f ? 1.0f / radiusRange.getLength() : 0.0f;
+            auto antialiasInnerEdge = innerRadius > 0.0f;
+            auto background = Vec4::fromColor(backgroundColor);
+
+            parallelForRows(height, rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<Color128> row((size_t)width);
+
+                    Vec4 const laneOffsets{ 0.5f, 1.5f, 2.5f, 3.5f };
+                    Vec4 const dxStep{ inverse.mat00 * 4.0f };
+                    Vec4 const dyStep{ inverse.mat10 * 4.0f };
+                    Vec4 const twoPi{ juce::MathConstants<float>::twoPi };
+                    Vec4 const entriesPerRadian{ (float)lookupTableSize / juce::MathConstants<float>::twoPi };
+
+                    for (int y = startRow; y < endRow; ++y)
+                    {
+                        auto pixelY = (float)y + 0.5f;
+                        auto gradientX = Vec4{ inverse.mat01 * pixelY + inverse.mat02 } + Vec4{ inverse.mat00 } * laneOffsets;
+                        auto gradientY = Vec4{ inverse.mat11 * pixelY + inverse.mat12 } + Vec4{ inverse.mat10 } * laneOffsets;
+
+                        for (int x = 0; x < width; x += 4, gradientX += dxStep, gradientY += dyStep)
+                        {
+                            //
+                            // Zero radians is straight up and angles increase clockwise, so measure from the negative y axis
+                            //
+                            auto radius = Vec4::sqrt(gradientX * gradientX + gradientY * gradientY);
+                            auto angle = atan2(gradientX, Vec4{ 0.0f } - gradientY);
+                            angle = Vec4::select(Vec4::lessThan(angle, Vec4{ 0.0f }), angle + twoPi, angle);
+
+                            auto coverage = Vec4::clamp((Vec4{ outerRadius } - radius) * Vec4{ pixelScale } + Vec4{ 0.5f }, 0.0f, 1.0f);
+                            if (antialiasInnerEdge)
+                                coverage *= Vec4::clamp((radius - Vec4{ innerRadius }) * Vec4{ pixelScale } + Vec4{ 0.5f }, 0.0f, 1.0f);
+
+                            alignas(16) float tablePositions[4], radialProportions[4], coverages[4];
+                            (angle * entriesPerRadian).store(tablePositions);
+                            Vec4::clamp((radius - Vec4{ innerRadius }) * Vec4{ inverseRadialLength }, 0.0f, 1.0f).store(radialProportions);
+                            coverage.store(coverages);
+
+                            auto numLanes = juce::jmin(4, width - x);
+                            for (int lane = 0; lane < numLanes; ++lane)
+                            {
+                                auto& pixel = row[(size_t)(x + lane)];
+                                if (coverages[lane] <= 0.0f)
+                                {
+                                    pixel = backgroundColor;
+                                    continue;
+                                }
+
+                                auto entry = juce::jlimit(0, lookupTableSize - 1, (int)tablePositions[lane]);
+                                auto fraction = Vec4{ tablePositions[lane] - (float)entry };
+                                auto inner = Vec4::lerp(Vec4::fromColor(innerColors[(size_t)entry]), Vec4::fromColor(innerColors[(size_t)entry + 1]), fraction);
+                                auto outer = Vec4::lerp(Vec4::fromColor(outerColors[(size_t)entry]), Vec4::fromColor(outerColors[(size_t)entry + 1]), fraction);
+                                auto color = Vec4::lerp(inner, outer, Vec4{ radialProportions[lane] }) * Vec4{ coverages[lane] };
+
+                                pixel = (color + background * (Vec4{ 1.0f } - color.broadcast(3))).toColor();
+                            }
+                        }
+
+                        storeRow(destination, 0, y, row.data(), width);
+                    }
+                });
+        }
+
+        std::vector<Color128> innerColors, outerColors;
+
+    private:
+        static void compositeOver(Color128& destination, Vec4 source) noexcept
+        {
+            auto result = source + Vec4::fromColor(destination) * (Vec4{ 1.0f } - source.broadcast(3));
+            destination = result.toColor();
+        }
+    };
+
+} // namespace mescal::software
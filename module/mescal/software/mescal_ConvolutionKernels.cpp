@@ -0,0 +1,709 @@
+namespace mescal::software
+{
+    /*
+
+        Convolution kernels for the software effect renderer
+
+        convolve applies an arbitrary Kernel and picks the cheapest way to do it:
+
+            separable   Kernels that are the outer product of a column and a row (box, Gaussian, Sobel, Prewitt) run as
+                        a horizontal pass and a vertical pass, so the cost per pixel grows with width + height rather than
+                        width * height. Kernels are factored automatically; callers never have to say they're separable.
+            stencil     Other 3x3 and 5x5 kernels compute four output pixels per step, with the weights and the input
+                        pixels the four outputs share held in registers.
+            fft         Wider kernels that don't factor are multiplied in the frequency domain one tile at a time
+                        (overlap-save), so the cost per pixel grows with the log of the tile size instead of the kernel area.
+            direct      Anything else accumulates one kernel weight at a time over whole rows.
+
+        Kernels are applied without flipping: output(x, y) is the sum of weight(i, j) * input(x + i - radiusX, y + j - radiusY).
+        Pixels outside the source buffer are transparent.
+
+        Edge detection and emboss are built from kernels here. A Gaussian blur followed by a Sobel or Prewitt filter is
+        still separable, so edge detection with a blur radius costs little more than without one.
+
+    */
+    struct ConvolutionKernels
+    {
+        static constexpr int minimumFFTKernelSize = 16;
+        static constexpr int maximumFFTSize = 512;
+
+        /**
+         * Weights for an odd width x odd height kernel, stored row by row; the center weight lines up with the output pixel
+         */
+        struct Kernel
+        {
+            int width = 1;
+            int height = 1;
+            std::vector<float> weights{ 1.0f };
+
+            float operator() (int x, int y) const noexcept
+            {
+                return weights[(size_t)(y * width + x)];
+            }
+
+            int getRadiusX() const noexcept { return width / 2; }
+            int getRadiusY() const noexcept { return height / 2; }
+
+            /**
+             * The kernel with weights column[y] * row[x]
+             */
+            static Kernel outerProduct(std::vector<float> const& column, std::vector<float> const& row)
+            {
+                Kernel kernel{ (int)row.size(), (int)column.size(), std::vector<float>(row.size() * column.size()) };
+                for (size_t y = 0; y < column.size(); ++y)
+                    for (size_t x = 0; x < row.size(); ++x)
+                        kernel.weights[y * row.size() + x] = column[y] * row[x];
+
+                return kernel;
+            }
+
+            /**
+             * Applying this kernel and then other is the same as applying the combined kernel once
+             */
+            Kernel combinedWith(Kernel const& other) const
+            {
+                Kernel combined{ width + other.width - 1, height + other.height - 1, {} };
+                combined.weights.resize((size_t)(combined.width * combined.height));
+
+                for (int y = 0; y < height; ++y)
+                    for (int x = 0; x < width; ++x)
+                        for (int otherY = 0; otherY < other.height; ++otherY)
+                            for (int otherX = 0; otherX < other.width; ++otherX)
+                                combined.weights[(size_t)((y + otherY) * combined.width + x + otherX)] += (*this)(x, y) * other(otherX, otherY);
+
+                return combined;
+            }
+
+            /**
+             * If the kernel is the outer product of a column and a row, returns the column and the row
+             */
+            std::optional<std::pair<std::vector<float>, std::vector<float>>> factor() const
+            {
+                //
+                // A rank-one kernel is its pivot row scaled by its pivot column; the largest weight makes the best pivot
+                //
+                auto pivot = (size_t)std::distance(weights.begin(), std::max_element(weights.begin(), weights.end(),
+                    [](float a, float b) { return std::abs(a) < std::abs(b); }));
+                auto pivotValue = weights[pivot];
+                if (pivotValue == 0.0f)
+                    return std::pair{ std::vector<float>((size_t)height), std::vector<float>((size_t)width) };
+
+                auto pivotX = (int)pivot % width;
+                auto pivotY = (int)pivot / width;
+
+                std::vector<float> column((size_t)height), row((size_t)width);
+                for (int x = 0; x < width; ++x)
+                    row[(size_t)x] = (*this)(x, pivotY);
+                for (int y = 0; y < height; ++y)
+                    column[(size_t)y] = (*this)(pivotX, y) / pivotValue;
+
+                auto tolerance = std::abs(pivotValue) * 1.0e-5f;
+                for (int y = 0; y < height; ++y)
+                    for (int x = 0; x < width; ++x)
+                        if (std::abs((*this)(x, y) - column[(size_t)y] * row[(size_t)x]) > tolerance)
+                            return std::nullopt;
+
+                return std::pair{ std::move(column), std::move(row) };
+            }
+        };
+
+        /**
+         * source must cover destination.area expanded by the kernel radius; anything it doesn't cover is transparent
+         */
+        template <typename Sample>
+        static void convolve(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, Kernel const& kernel)
+        {
+            jassert(kernel.width % 2 == 1 && kernel.height % 2 == 1);
+            if (destination.area.isEmpty())
+                return;
+
+            if (auto factors = kernel.factor())
+                convolveSeparable(source, destination, factors->first, factors->second);
+            else if (kernel.width == 3 && kernel.height == 3)
+                convolveStencil<3>(source, destination, kernel);
+            else if (kernel.width == 5 && kernel.height == 5)
+                convolveStencil<5>(source, destination, kernel);
+            else if (juce::jmax(kernel.width, kernel.height) >= minimumFFTKernelSize && juce::jmax(kernel.width, kernel.height) * 2 <= maximumFFTSize)
+                convolveFFT(source, destination, kernel);
+            else
+                convolveDirect(source, destination, kernel);
+        }
+
+        /**
+         * A normalized Gaussian truncated at three standard deviations; zero gives the identity kernel
+         */
+        static Kernel getGaussianKernel(float standardDeviation)
+        {
+            auto radius = getGaussianRadius(standardDeviation);
+            if (radius == 0)
+                return {};
+
+            std::vector<float> weights((size_t)(radius * 2 + 1));
+            auto sum = 0.0f;
+            for (int offset = -radius; offset <= radius; ++offset)
+            {
+                auto weight = std::exp(-(float)(offset * offset) / (2.0f * standardDeviation * standardDeviation));
+                weights[(size_t)(offset + radius)] = weight;
+                sum += weight;
+            }
+
+            for (auto& weight : weights)
+                weight /= sum;
+
+            return Kernel::outerProduct(weights, weights);
+        }
+
+        static int getGaussianRadius(float standardDeviation) noexcept
+        {
+            return standardDeviation > 0.0f ? (int)std::ceil(standardDeviation * 3.0f) : 0;
+        }
+
+        /**
+         * Sobel or Prewitt gradient kernel, scaled so a step from 0 to 1 gives a gradient of 1
+         */
+        static Kernel getGradientKernel(int mode, bool vertical)
+        {
+            auto smoothing = mode == Effect::EdgeDetection::prewitt ? std::vector<float>{ 1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f }
+                : std::vector<float>{ 0.25f, 0.5f, 0.25f };
+            auto difference = std::vector<float>{ -1.0f, 0.0f, 1.0f };
+
+            return vertical ? Kernel::outerProduct(difference, smoothing) : Kernel::outerProduct(smoothing, difference);
+        }
+
+        /**
+         * Directional derivative lit from direction degrees counterclockwise from the positive x axis; with a height
+         * of 1, a step from 0 to 1 facing the light gives 0.5
+         */
+        static Kernel getEmbossKernel(float height, float direction)
+        {
+            auto angle = juce::degreesToRadians(direction);
+            auto directionX = std::cos(angle) * height / 6.0f;
+            auto directionY = -std::sin(angle) * height / 6.0f;
+
+            Kernel kernel{ 3, 3, std::vector<float>(9) };
+            for (int y = -1; y <= 1; ++y)
+                for (int x = -1; x <= 1; ++x)
+                    kernel.weights[(size_t)((y + 1) * 3 + x + 1)] = (float)x * directionX + (float)y * directionY;
+
+            return kernel;
+        }
+
+        static int getEdgeDetectRadius(float blurRadius) noexcept
+        {
+            return getGaussianRadius(blurRadius) + 1;
+        }
+
+        /**
+         * Gradient magnitude of each premultiplied channel after an optional Gaussian blur, scaled by strength * 2 so
+         * the default strength of 0.5 maps a full step to 1. The edge alpha is the strongest channel. With overlayEdges
+         * set, the edges are drawn over the source; otherwise only the edges are returned.
+         *
+         * source must cover destination.area expanded by getEdgeDetectRadius(blurRadius).
+         */
+        static void edgeDetect(PixelBuffer const& source, PixelBuffer& destination, float strength, float blurRadius, int mode, bool overlayEdges)
+        {
+            auto smoothing = getGaussianKernel(blurRadius);
+
+            PixelBuffer verticalGradient{ destination.area };
+            convolve(source, destination, smoothing.combinedWith(getGradientKernel(mode, false)));
+            convolve(source, verticalGradient, smoothing.combinedWith(getGradientKernel(mode, true)));
+
+            Vec4 const gain{ strength * 2.0f }, one{ 1.0f };
+            auto const& area = destination.area;
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto output = destination.getRow(y);
+                        auto vertical = verticalGradient.getRow(y);
+                        auto input = source.getRow(y) + (area.getX() - source.area.getX());
+
+                        for (int column = 0; column < area.getWidth(); ++column)
+                        {
+                            auto gradientX = Vec4::fromColor(output[column]);
+                            auto gradientY = Vec4::fromColor(vertical[column]);
+                            auto edges = Vec4::min(Vec4::sqrt(gradientX * gradientX + gradientY * gradientY) * gain, one);
+                            auto edgeAlpha = Vec4::max(Vec4::max(edges.broadcast(0), edges.broadcast(1)), Vec4::max(edges.broadcast(2), edges.broadcast(3)));
+                            edges = Vec4::select(EffectKernels::getColorLanes(), edges, edgeAlpha);
+
+                            if (overlayEdges)
+                                edges = edges + Vec4::fromColor(input[column]) * (one - edgeAlpha);
+
+                            output[column] = edges.toColor();
+                        }
+                    }
+                });
+        }
+
+        /**
+         * Grey relief of the source luminance with the source alpha; flat areas are mid-grey.
+         *
+         * source must cover destination.area expanded by 1.
+         */
+        static void emboss(PixelBuffer const& source, PixelBuffer& destination, float height, float direction)
+        {
+            AlphaBuffer luminance{ source.area };
+            parallelForRows(source.area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    auto width = (size_t)source.area.getWidth();
+                    for (auto index = (size_t)startRow * width, end = (size_t)endRow * width; index < end; ++index)
+                    {
+                        auto const& pixel = source.pixels[index];
+                        luminance.pixels[index] = 0.2125f * pixel.red + 0.7154f * pixel.green + 0.0721f * pixel.blue;
+                    }
+                });
+
+            AlphaBuffer relief{ destination.area };
+            convolve(luminance, relief, getEmbossKernel(height, direction));
+
+            auto const& area = destination.area;
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto output = destination.getRow(y);
+                        auto slope = relief.getRow(y);
+                        auto input = source.getRow(y) + (area.getX() - source.area.getX());
+
+                        for (int column = 0; column < area.getWidth(); ++column)
+                        {
+                            auto alpha = input[column].alpha;
+                            auto grey = juce::jlimit(0.0f, alpha, alpha * 0.5f + slope[column]);
+                            output[column] = { grey, grey, grey, alpha };
+                        }
+                    }
+                });
+        }
+
+    private:
+        struct Complex
+        {
+            float real = 0.0f;
+            float imaginary = 0.0f;
+
+            friend Complex operator+ (Complex a, Complex b) noexcept { return { a.real + b.real, a.imaginary + b.imaginary }; }
+            friend Complex operator- (Complex a, Complex b) noexcept { return { a.real - b.real, a.imaginary - b.imaginary }; }
+            friend Complex operator* (Complex a, Complex b) noexcept
+            {
+                return { a.real * b.real - a.imaginary * b.imaginary, a.real * b.imaginary + a.imaginary * b.real };
+            }
+        };
+
+        /**
+         * Radix-2 complex FFT for one power-of-two size
+         */
+        struct FFT
+        {
+            explicit FFT(int size_) :
+                size(size_),
+                twiddles((size_t)size_ / 2),
+                reversed((size_t)size_)
+            {
+                jassert(juce::isPowerOfTwo(size));
+
+                for (int index = 0; index < size / 2; ++index)
+                {
+                    auto angle = -juce::MathConstants<double>::twoPi * (double)index / (double)size;
+                    twiddles[(size_t)index] = { (float)std::cos(angle), (float)std::sin(angle) };
+                }
+
+                auto numBits = 0;
+                while ((1 << numBits) < size)
+                    ++numBits;
+
+                for (int index = 0; index < size; ++index)
+                {
+                    auto reversedIndex = 0;
+                    for (int bit = 0; bit < numBits; ++bit)
+                        reversedIndex |= ((index >> bit) & 1) << (numBits - 1 - bit);
+
+                    reversed[(size_t)index] = reversedIndex;
+                }
+            }
+
+            /**
+             * In-place transform of size contiguous values; the inverse is not scaled
+             */
+            void transform(Complex* data, bool inverse) const noexcept
+            {
+                for (int index = 0; index < size; ++index)
+                    if (index < reversed[(size_t)index])
+                        std::swap(data[index], data[reversed[(size_t)index]]);
+
+                for (int length = 2; length <= size; length <<= 1)
+                {
+                    auto half = length / 2;
+                    auto step = size / length;
+                    for (int start = 0; start < size; start += length)
+                    {
+                        for (int index = 0; index < half; ++index)
+                        {
+                            auto twiddle = twiddles[(size_t)(index * step)];
+                            if (inverse)
+                                twiddle.imaginary = -twiddle.imaginary;
+
+                            auto even = data[start + index];
+                            auto odd = data[start + index + half] * twiddle;
+                            data[start + index] = even + odd;
+                            data[start + index + half] = even - odd;
+                        }
+                    }
+                }
+            }
+
+            /**
+             * In-place transform of a size x size block stored row by row
+             */
+            void transform2D(Complex* data, bool inverse, std::vector<Complex>& column) const noexcept
+            {
+                for (int row = 0; row < size; ++row)
+                    transform(data + (size_t)row * (size_t)size, inverse);
+
+                column.resize((size_t)size);
+                for (int x = 0; x < size; ++x)
+                {
+                    for (int y = 0; y < size; ++y)
+                        column[(size_t)y] = data[(size_t)y * (size_t)size + (size_t)x];
+
+                    transform(column.data(), inverse);
+
+                    for (int y = 0; y < size; ++y)
+                        data[(size_t)y * (size_t)size + (size_t)x] = column[(size_t)y];
+                }
+            }
+
+            int const size;
+            std::vector<Complex> twiddles;
+            std::vector<int> reversed;
+        };
+
+        /**
+         * Copies length pixels of row y starting at column startX; pixels outside source are transparent
+         */
+        template <typename Sample>
+        static void fetchRow(ImageBuffer<Sample> const& source, int startX, int y, Sample* row, int length) noexcept
+        {
+            std::fill_n(row, length, Sample{});
+            if (y < source.area.getY() || y >= source.area.getBottom())
+                return;
+
+            auto start = juce::jmax(startX, source.area.getX());
+            auto end = juce::jmin(startX + length, source.area.getRight());
+            if (start < end)
+                std::copy_n(source.getRow(y) + (start - source.area.getX()), end - start, row + (start - startX));
+        }
+
+        /**
+         * The source rows under a kernel as it moves down the image one row at a time
+         */
+        template <typename Sample>
+        struct RowWindow
+        {
+            RowWindow(ImageBuffer<Sample> const& source_, int startX_, int length_, int numRows, int topY_) :
+                source(source_),
+                startX(startX_),
+                length(length_),
+                topY(topY_),
+                rows((size_t)numRows, std::vector<Sample>((size_t)length_))
+            {
+                for (size_t index = 0; index < rows.size(); ++index)
+                    fetchRow(source, startX, topY + (int)index, rows[index].data(), length);
+            }
+
+            void advance() noexcept
+            {
+                std::rotate(rows.begin(), rows.begin() + 1, rows.end());
+                ++topY;
+                fetchRow(source, startX, topY + (int)rows.size() - 1, rows.back().data(), length);
+            }
+
+            Sample const* operator[] (int index) const noexcept
+            {
+                return rows[(size_t)index].data();
+            }
+
+            ImageBuffer<Sample> const& source;
+            int const startX;
+            int const length;
+            int topY;
+            std::vector<std::vector<Sample>> rows;
+        };
+
+        /**
+         * output[i] += input[i] * weight
+         */
+        template <typename Sample>
+        static void accumulate(Sample* output, Sample const* input, float weight, int count) noexcept
+        {
+            using Traits = SampleTraits<Sample>;
+
+            auto splatWeight = Traits::splat(weight);
+            for (int index = 0; index < count; ++index)
+                output[index] = Traits::store(Traits::load(output[index]) + Traits::load(input[index]) * splatWeight);
+        }
+
+        template <typename Sample>
+        static void convolveSeparable(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination,
+            std::vector<float> const& column, std::vector<float> const& row)
+        {
+            auto const& area = destination.area;
+            auto width = area.getWidth();
+            auto radiusX = (int)row.size() / 2;
+            auto radiusY = (int)column.size() / 2;
+
+            //
+            // Horizontal pass into an intermediate buffer with radiusY extra rows above and below
+            //
+            ImageBuffer<Sample> intermediate{ area.expanded(0, radiusY) };
+            parallelForRows(intermediate.area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<Sample> line((size_t)(width + radiusX * 2));
+                    for (int y = intermediate.area.getY() + startRow; y < intermediate.area.getY() + endRow; ++y)
+                    {
+                        fetchRow(source, area.getX() - radiusX, y, line.data(), (int)line.size());
+
+                        auto output = intermediate.getRow(y);
+                        for (size_t tap = 0; tap < row.size(); ++tap)
+                            if (row[tap] != 0.0f)
+                                accumulate(output, line.data() + tap, row[tap], width);
+                    }
+                });
+
+            //
+            // Vertical pass a whole row at a time
+            //
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto output = destination.getRow(y);
+                        std::fill_n(output, width, Sample{});
+
+                        for (size_t tap = 0; tap < column.size(); ++tap)
+                            if (column[tap] != 0.0f)
+                                accumulate(output, intermediate.getRow(y - radiusY + (int)tap), column[tap], width);
+                    }
+                });
+        }
+
+        /**
+         * Fixed-size kernels computed four output pixels at a time. Alpha buffers hold the four pixels in the lanes of
+         * one Vec4; color buffers keep a Vec4 per pixel and load each input pixel once for all four outputs.
+         */
+        template <int size, typename Sample>
+        static void convolveStencil(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, Kernel const& kernel)
+        {
+            constexpr int radius = size / 2;
+            constexpr int block = 4;
+
+            std::array<Vec4, size * size> weights;
+            for (size_t index = 0; index < weights.size(); ++index)
+                weights[index] = Vec4{ kernel.weights[index] };
+
+            auto const& area = destination.area;
+            auto width = area.getWidth();
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    //
+                    // The padding on the right keeps the last block of four in bounds
+                    //
+                    auto firstY = area.getY() + startRow;
+                    RowWindow<Sample> window{ source, area.getX() - radius, width + size - 1 + block - 1, size, firstY - radius };
+
+                    for (int y = firstY; y < area.getY() + endRow; ++y)
+                    {
+                        if (y > firstY)
+                            window.advance();
+
+                        auto output = destination.getRow(y);
+                        for (int column = 0; column < width; column += block)
+                        {
+                            auto numOutputs = juce::jmin(block, width - column);
+
+                            if constexpr (std::is_same_v<Sample, float>)
+                            {
+                                Vec4 sum;
+                                for (int kernelY = 0; kernelY < size; ++kernelY)
+                                    for (int kernelX = 0; kernelX < size; ++kernelX)
+                                        sum += weights[(size_t)(kernelY * size + kernelX)] * Vec4::load(window[kernelY] + column + kernelX);
+
+                                alignas(16) float lanes[block];
+                                sum.store(lanes);
+                                std::copy_n(lanes, numOutputs, output + column);
+                            }
+                            else
+                            {
+                                std::array<Vec4, block> sums;
+                                for (int kernelY = 0; kernelY < size; ++kernelY)
+                                {
+                                    std::array<Vec4, block + size - 1> pixels;
+                                    for (size_t index = 0; index < pixels.size(); ++index)
+                                        pixels[index] = Vec4::fromColor(window[kernelY][column + (int)index]);
+
+                                    for (int kernelX = 0; kernelX < size; ++kernelX)
+                                        for (int index = 0; index < block; ++index)
+                                            sums[(size_t)index] += weights[(size_t)(kernelY * size + kernelX)] * pixels[(size_t)(kernelX + index)];
+                                }
+
+                                for (int index = 0; index < numOutputs; ++index)
+                                    output[column + index] = sums[(size_t)index].toColor();
+                            }
+                        }
+                    }
+                });
+        }
+
+        template <typename Sample>
+        static void convolveDirect(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, Kernel const& kernel)
+        {
+            auto const& area = destination.area;
+            auto width = area.getWidth();
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    auto firstY = area.getY() + startRow;
+                    RowWindow<Sample> window{ source, area.getX() - kernel.getRadiusX(), width + kernel.width - 1, kernel.height, firstY - kernel.getRadiusY() };
+
+                    for (int y = firstY; y < area.getY() + endRow; ++y)
+                    {
+                        if (y > firstY)
+                            window.advance();
+
+                        auto output = destination.getRow(y);
+                        std::fill_n(output, width, Sample{});
+
+                        for (int kernelY = 0; kernelY < kernel.height; ++kernelY)
+                            for (int kernelX = 0; kernelX < kernel.width; ++kernelX)
+                                if (auto weight = kernel(kernelX, kernelY); weight != 0.0f)
+                                    accumulate(output, window[kernelY] + kernelX, weight, width);
+                    }
+                });
+        }
+
+        /**
+         * Power-of-two tile size for the FFT; large enough that most of each tile is usable output, but no larger
+         * than the output needs
+         */
+        static int getFFTSize(Kernel const& kernel, juce::Rectangle<int> area) noexcept
+        {
+            auto extent = juce::jmax(kernel.width, kernel.height);
+            auto needed = juce::jmax(area.getWidth() + kernel.width, area.getHeight() + kernel.height);
+
+            auto size = 64;
+            while (size < extent * 4 && size < needed && size < maximumFFTSize)
+                size *= 2;
+
+            return size;
+        }
+
+        /**
+         * Overlap-save: each tile of fftSize x fftSize source pixels is multiplied by the spectrum of the kernel, and the
+         * part of the circular convolution that doesn't wrap around is the output for that tile
+         */
+        template <typename Sample>
+        static void convolveFFT(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, Kernel const& kernel)
+        {
+            constexpr bool isColor = !std::is_same_v<Sample, float>;
+
+            auto const& area = destination.area;
+            auto fftSize = getFFTSize(kernel, area);
+            auto numValues = (size_t)fftSize * (size_t)fftSize;
+            auto validWidth = fftSize - kernel.width + 1;
+            auto validHeight = fftSize - kernel.height + 1;
+            FFT const fft{ fftSize };
+
+            //
+            // Convolution flips the kernel; flipping it first gives the unflipped result this file uses. The inverse
+            // transform's 1 / (fftSize * fftSize) scale is folded in as well.
+            //
+            std::vector<Complex> spectrum(numValues);
+            {
+                auto scale = 1.0f / (float)numValues;
+                for (int y = 0; y < kernel.height; ++y)
+                    for (int x = 0; x < kernel.width; ++x)
+                        spectrum[(size_t)y * (size_t)fftSize + (size_t)x].real = kernel(kernel.width - 1 - x, kernel.height - 1 - y) * scale;
+
+                std::vector<Complex> column;
+                fft.transform2D(spectrum.data(), false, column);
+            }
+
+            auto numTilesX = (area.getWidth() + validWidth - 1) / validWidth;
+            auto numTilesY = (area.getHeight() + validHeight - 1) / validHeight;
+
+            parallelFor(numTilesX * numTilesY, [&](int tile)
+                {
+                    juce::Rectangle<int> tileArea{ area.getX() + (tile % numTilesX) * validWidth, area.getY() + (tile / numTilesX) * validHeight, validWidth, validHeight };
+                    tileArea = tileArea.getIntersection(area);
+
+                    auto readArea = juce::Rectangle<int>{ tileArea.getX() - kernel.getRadiusX(), tileArea.getY() - kernel.getRadiusY(), fftSize, fftSize };
+                    if (!readArea.intersects(source.area))
+                    {
+                        for (int y = tileArea.getY(); y < tileArea.getBottom(); ++y)
+                            std::fill_n(destination.getRow(y) + (tileArea.getX() - area.getX()), tileArea.getWidth(), Sample{});
+                        return;
+                    }
+
+                    //
+                    // Two real channels share each complex transform; the kernel is real, so they stay apart.
+                    // Color pixels pack red and green into one transform and blue and alpha into another.
+                    //
+                    constexpr size_t numFields = isColor ? 2 : 1;
+                    std::array<std::vector<Complex>, numFields> fields;
+                    for (auto& field : fields)
+                        field.resize(numValues);
+
+                    std::vector<Sample> line((size_t)fftSize);
+                    for (int y = 0; y < fftSize; ++y)
+                    {
+                        fetchRow(source, readArea.getX(), readArea.getY() + y, line.data(), fftSize);
+                        auto offset = (size_t)y * (size_t)fftSize;
+
+                        for (size_t x = 0; x < (size_t)fftSize; ++x)
+                        {
+                            if constexpr (isColor)
+                            {
+                                fields[0][offset + x] = { line[x].red, line[x].green };
+                                fields[1][offset + x] = { line[x].blue, line[x].alpha };
+                            }
+                            else
+                            {
+                                fields[0][offset + x] = { line[x], 0.0f };
+                            }
+                        }
+                    }
+
+                    std::vector<Complex> column;
+                    for (auto& field : fields)
+                    {
+                        fft.transform2D(field.data(), false, column);
+                        for (size_t index = 0; index < numValues; ++index)
+                            field[index] = field[index] * spectrum[index];
+                        fft.transform2D(field.data(), true, column);
+                    }
+
+                    for (int y = tileArea.getY(); y < tileArea.getBottom(); ++y)
+                    {
+                        auto output = destination.getRow(y) + (tileArea.getX() - area.getX());
+                        auto offset = (size_t)(y - tileArea.getY() + kernel.height - 1) * (size_t)fftSize + (size_t)(kernel.width - 1);
+
+                        for (size_t x = 0; x < (size_t)tileArea.getWidth(); ++x)
+                        {
+                            if constexpr (isColor)
+                            {
+                                auto redGreen = fields[0][offset + x];
+                                auto blueAlpha = fields[1][offset + x];
+                                output[x] = { redGreen.real, redGreen.imaginary, blueAlpha.real, blueAlpha.imaginary };
+                            }
+                            else
+                            {
+                                output[x] = fields[0][offset + x].real;
+                            }
+                        }
+                    }
+                });
+        }
+    };
+
+} // namespace mescal::software
@@ -0,0 +1,315 @@
+namespace mescal::software
+{
+    /*
+
+        Pixel kernels for the software effect renderer
+
+        A PixelBuffer holds premultiplied Color128 pixels covering a rectangle in effect space; effect space is the
+        same pixel grid the Direct2D effects use, with the input images positioned at the origin. Every kernel reads
+        and writes PixelBuffers and follows the formulas documented for the matching Direct2D built-in effect.
+
+        An AlphaBuffer holds just the alpha channel, for effects whose output only matters for its alpha (such as
+        the input to a shadow or the mask for an alpha mask). Kernels that work the same way on every channel are
+        templated on the sample type so they can run on either kind of buffer.
+
+        Kernels split their work into bands of rows and run the bands on the shared worker pool.
+
+    */
+    template <typename Sample>
+    struct ImageBuffer
+    {
+        ImageBuffer() = default;
+        explicit ImageBuffer(juce::Rectangle<int> area_) :
+            area(area_.isEmpty() ? juce::Rectangle<int>{ area_.getX(), area_.getY(), 0, 0 } : area_),
+            pixels((size_t)area.getWidth() * (size_t)area.getHeight())
+        {
+        }
+
+        /** y is in effect space, not relative to the top of the buffer */
+        Sample* getRow(int y) noexcept
+        {
+            return pixels.data() + (size_t)(y - area.getY()) * (size_t)area.getWidth();
+        }
+
+        Sample const* getRow(int y) const noexcept
+        {
+            return pixels.data() + (size_t)(y - area.getY()) * (size_t)area.getWidth();
+        }
+
+        juce::Rectangle<int> area;
+        PooledVector<Sample> pixels;
+    };
+
+    using PixelBuffer = ImageBuffer<Color128>;
+    using AlphaBuffer = ImageBuffer<float>;
+
+    /**
+     * Arithmetic on a single sample; Value is Vec4 for color pixels and float for alpha
+     */
+    template <typename Sample>
+    struct SampleTraits;
+
+    template <>
+    struct SampleTraits<Color128>
+    {
+        using Value = Vec4;
+
+        static Vec4 load(Color128 sample) noexcept { return Vec4::fromColor(sample); }
+        static Color128 store(Vec4 value) noexcept { return value.toColor(); }
+        static Vec4 splat(float value) noexcept { return Vec4{ value }; }
+        static Vec4 lerp(Vec4 a, Vec4 b, Vec4 t) noexcept { return Vec4::lerp(a, b, t); }
+    };
+
+    template <>
+    struct SampleTraits<float>
+    {
+        using Value = float;
+
+        static float load(float sample) noexcept { return sample; }
+        static float store(float value) noexcept { return value; }
+        static float splat(float value) noexcept { return value; }
+        static float lerp(float a, float b, float t) noexcept { return a + (b - a) * t; }
+    };
+
+    struct EffectKernels
+    {
+        static constexpr int rowsPerBand = 16;
+
+        /** Mask for Vec4::select that picks the red, green, and blue lanes */
+        static Vec4 getColorLanes() noexcept
+        {
+            return Vec4::lessThan(Vec4{ 0.0f, 0.0f, 0.0f, 1.0f }, Vec4{ 0.5f });
+        }
+
+        /**
+         * Copies the overlapping part of source into destination; the rest of destination is left unchanged
+         */
+        template <typename Sample>
+        static void copy(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination)
+        {
+            auto overlap = source.area.getIntersection(destination.area);
+            if (overlap.isEmpty())
+                return;
+
+            parallelForRows(overlap.getHeight(), rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = overlap.getY() + startRow; y < overlap.getY() + endRow; ++y)
+                    {
+                        std::copy_n(source.getRow(y) + (overlap.getX() - source.area.getX()),
+                            overlap.getWidth(),
+                            destination.getRow(y) + (overlap.getX() - destination.area.getX()));
+                    }
+                });
+        }
+
+        template <typename Function>
+        static void forEachPixel(PixelBuffer& buffer, Function&& function)
+        {
+            auto width = (size_t)buffer.area.getWidth();
+            parallelForRows(buffer.area.getHeight(), rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (auto pixel = buffer.pixels.data() + (size_t)startRow * width, end = buffer.pixels.data() + (size_t)endRow * width; pixel < end; ++pixel)
+                    {
+                        *pixel = function(Vec4::fromColor(*pixel)).toColor();
+                    }
+                });
+        }
+
+        /**
+         * Combines each destination pixel with the matching source pixel; both buffers must cover the same area
+         */
+        template <typename Function>
+        static void forEachPixelPair(PixelBuffer& destination, PixelBuffer const& source, Function&& function)
+        {
+            jassert(source.area == destination.area);
+
+            auto width = (size_t)destination.area.getWidth();
+            parallelForRows(destination.area.getHeight(), rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (auto index = (size_t)startRow * width, end = (size_t)endRow * width; index < end; ++index)
+                    {
+                        auto& pixel = destination.pixels[index];
+                        pixel = function(Vec4::fromColor(pixel), Vec4::fromColor(source.pixels[index])).toColor();
+                    }
+                });
+        }
+
+        /**
+         * Copies the alpha channel of the overlapping part of source into destination
+         */
+        static void extractAlpha(PixelBuffer const& source, AlphaBuffer& destination)
+        {
+            auto overlap = source.area.getIntersection(destination.area);
+            if (overlap.isEmpty())
+                return;
+
+            parallelForRows(overlap.getHeight(), rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = overlap.getY() + startRow; y < overlap.getY() + endRow; ++y)
+                    {
+                        auto input = source.getRow(y) + (overlap.getX() - source.area.getX());
+                        auto output = destination.getRow(y) + (overlap.getX() - destination.area.getX());
+                        for (int x = 0; x < overlap.getWidth(); ++x)
+                            output[x] = input[x].alpha;
+                    }
+                });
+        }
+
+        /**
+         * Copies the overlapping part of source into destination as black pixels with the source alpha
+         */
+        static void expandAlpha(AlphaBuffer const& source, PixelBuffer& destination)
+        {
+            auto overlap = source.area.getIntersection(destination.area);
+            if (overlap.isEmpty())
+                return;
+
+            parallelForRows(overlap.getHeight(), rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = overlap.getY() + startRow; y < overlap.getY() + endRow; ++y)
+                    {
+                        auto input = source.getRow(y) + (overlap.getX() - source.area.getX());
+                        auto output = destination.getRow(y) + (overlap.getX() - destination.area.getX());
+                        for (int x = 0; x < overlap.getWidth(); ++x)
+                            output[x] = { 0.0f, 0.0f, 0.0f, input[x] };
+                    }
+                });
+        }
+
+        static void flood(PixelBuffer& buffer, Color128 premultipliedColor)
+        {
+            std::fill(buffer.pixels.begin(), buffer.pixels.end(), premultipliedColor);
+        }
+
+        static void invert(PixelBuffer& buffer)
+        {
+            forEachPixel(buffer, invertPixel);
+        }
+
+        static Vec4 invertPixel(Vec4 pixel) noexcept
+        {
+            //
+            // Inverting the straight color (1 - c) and premultiplying again gives alpha - c
+            //
+            return Vec4::select(getColorLanes(), pixel.broadcast(3) - pixel, pixel);
+        }
+
+        /**
+         * Luminance to alpha only produces alpha, so it always writes into an AlphaBuffer
+         */
+        static void luminanceToAlpha(PixelBuffer const& source, AlphaBuffer& destination)
+        {
+            jassert(source.area == destination.area);
+
+            parallelForRows(source.area.getHeight(), rowsPerBand, [&](int startRow, int endRow)
+                {
+                    auto width = (size_t)source.area.getWidth();
+                    for (auto index = (size_t)startRow * width, end = (size_t)endRow * width; index < end; ++index)
+                        destination.pixels[index] = luminanceToAlphaPixel(Vec4::fromColor(source.pixels[index])).toColor().alpha;
+                });
+        }
+
+        static Vec4 luminanceToAlphaPixel(Vec4 pixel) noexcept
+        {
+            alignas(16) float channels[4];
+            pixel.store(channels);
+            if (channels[3] <= 0.0f)
+                return Vec4{};
+
+            auto luminance = (0.2125f * channels[0] + 0.7154f * channels[1] + 0.0721f * channels[2]) / channels[3];
+            return Vec4{ 0.0f, 0.0f, 0.0f, juce::jlimit(0.0f, 1.0f, luminance) };
+        }
+
+        /**
+         * The mask only contributes its alpha channel; destination can be a PixelBuffer or an AlphaBuffer
+         */
+        template <typename Sample>
+        static void alphaMask(ImageBuffer<Sample>& destination, AlphaBuffer const& mask)
+        {
+            using Traits = SampleTraits<Sample>;
+            jassert(destination.area == mask.area);
+
+            parallelForRows(destination.area.getHeight(), rowsPerBand, [&](int startRow, int endRow)
+                {
+                    auto width = (size_t)destination.area.getWidth();
+                    for (auto index = (size_t)startRow * width, end = (size_t)endRow * width; index < end; ++index)
+                        destination.pixels[index] = Traits::store(Traits::load(destination.pixels[index]) * Traits::splat(mask.pixels[index]));
+                });
+        }
+
+        static Vec4 alphaMaskPixel(Vec4 pixel, Vec4 maskPixel) noexcept
+        {
+            return pixel * maskPixel.broadcast(3);
+        }
+
+        /**
+         * result = c0 * source * destination + c1 * source + c2 * destination + c3
+         *
+         * Input 0 is the source and input 1 is the destination.
+         */
+        static void arithmeticComposite(PixelBuffer& source, PixelBuffer const& destination, Vector4 coefficients, bool clampOutput)
+        {
+            ArithmeticCoefficients const arithmetic{ coefficients, clampOutput };
+
+            forEachPixelPair(source, destination, [&](Vec4 sourcePixel, Vec4 destinationPixel)
+                {
+                    return arithmetic.apply(sourcePixel, destinationPixel);
+                });
+        }
+
+        struct ArithmeticCoefficients
+        {
+            ArithmeticCoefficients(Vector4 coefficients, bool clampOutput_) :
+                c0(coefficients[0]), c1(coefficients[1]), c2(coefficients[2]), c3(coefficients[3]), clampOutput(clampOutput_)
+            {
+            }
+
+            Vec4 apply(Vec4 source, Vec4 destination) const noexcept
+            {
+                auto result = c0 * source * destination + c1 * source + c2 * destination + c3;
+                return clampOutput ? Vec4::clamp(result, 0.0f, 1.0f) : result;
+            }
+
+            Vec4 c0, c1, c2, c3;
+            bool clampOutput;
+        };
+
+        /**
+         * Clips the buffer to cropRect. With soft edges, pixels partly covered by the rectangle are scaled by
+         * their coverage; with hard edges, pixels are kept if their centers are inside the rectangle.
+         */
+        template <typename Sample>
+        static void crop(ImageBuffer<Sample>& buffer, juce::Rectangle<float> cropRect, bool hardEdges)
+        {
+            using Traits = SampleTraits<Sample>;
+
+            auto coverage = [&](float start, float end, int pixel)
+                {
+                    if (hardEdges)
+                    {
+                        auto center = (float)pixel + 0.5f;
+                        return center >= start && center < end ? 1.0f : 0.0f;
+                    }
+
+                    return juce::jlimit(0.0f, 1.0f, juce::jmin((float)pixel + 1.0f, end) - juce::jmax((float)pixel, start));
+                };
+
+            auto const& area = buffer.area;
+            parallelForRows(area.getHeight(), rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto row = buffer.getRow(y);
+                        auto rowCoverage = coverage(cropRect.getY(), cropRect.getBottom(), y);
+
+                        for (int column = 0; column < area.getWidth(); ++column)
+                        {
+                            auto pixelCoverage = rowCoverage * coverage(cropRect.getX(), cropRect.getRight(), area.getX() + column);
+                            row[column] = Traits::store(Traits::load(row[column]) * Traits::splat(pixelCoverage));
+                        }
+                    }
+                });
+        }
+    };
+
+} // namespace mescal::software
@@ -0,0 +1,2049 @@
+namespace mescal::software
+{
+    /*
+
+        Software renderer for effect graphs
+
+        Rendering happens in three steps:
+
+        1. The graph is flattened into a list of nodes in topological order, so every node comes after its inputs. An
+           Effect or Image that feeds several downstream effects becomes a single node, so shared branches are
+           visited and evaluated only once no matter how many paths lead to them.
+
+        2. Walking the list backwards, each node works out which area of each input it needs (a blur needs its
+           radius of extra pixels on every side, an affine transform needs the inverse-mapped area, and so on).
+           An input's area is the union of what its consumers need, clipped to the area where the input can have
+           any non-transparent pixels. Only pixels that can reach the dirty region of the output image are
+           ever computed.
+
+        3. Each node gets a level one higher than its deepest input. Nodes on the same level don't depend on each
+           other, so each level is handed to parallelFor and independent branches run at the same time. Idle
+           threads pull the next node from the shared counter; the kernels inside each node split their rows
+           across the same pool.
+
+        While the graph is flattened, nodes that can't change the result are left out. A transform with an identity
+        matrix, a blur with no radius, a crop that's larger than its input, an arithmetic composite that only passes
+        one input through, and a composite with a single input all hand their consumers their input node instead.
+        Consecutive affine transforms with soft borders and the same interpolation become one node with the combined
+        matrix, so the image is only resampled once. Point-wise effects whose inputs are all constant (a flood, or
+        anything fed only by floods) are evaluated for a single pixel and become a solid fill, and whatever a
+        composite draws underneath an opaque fill is dropped. Nodes left with no consumers are then removed.
+
+        An Effect::Plan keeps its renderer between runs, so the first step only happens once. On each later run the
+        renderer checks just the effects that have had an input set since then: an input that's still the same Effect
+        or Image needs nothing, a new Image takes over the old one's node, and anything else builds the graph again.
+        The bounds and generation of every node are refreshed to pick up property changes. A property change on an
+        effect that was left out, merged or folded builds the graph again too, since the optimisation may no longer
+        hold.
+
+        Before running, chains of point-wise effects (where each effect's output is only read by the next effect in
+        the chain) are grouped into a single FusedEffectKernel, which runs the whole chain in one pass over the
+        pixels instead of writing an intermediate buffer for every effect.
+
+        Each Effect keeps its last output in an EffectCache, together with the Effect version and the generations
+        of the inputs it was computed from. While building the graph, a node whose version and input generations
+        still match keeps its generation; otherwise it gets a new one, which in turn invalidates every node
+        downstream. An up-to-date node whose cached output covers the requested area isn't run at all, so changing
+        one property only re-runs the effects between that property and the output. Image inputs aren't cached;
+        they're loaded again when a consumer needs them and released once every consumer has run.
+
+        Keeping every output around is only worth it for effects that stay the same from one render to the next. An
+        effect whose output had to be thrown away because something upstream changed is likely to change again
+        (an animated property or a new input image every frame), so its output is transient: it's released as soon
+        as its last consumer has run, just like an input image. Walking the levels in order, each buffer is live
+        from the node that writes it to the last node that reads it, so for a chain that changes every frame only
+        the buffers along the current level are held at once rather than one per node. Every ImageBuffer comes
+        from the BufferPool, so a released buffer goes straight to the next node that needs one of that size, in
+        this render or the next.
+
+        A large render of a graph that keeps changing runs a tile at a time instead. The transient nodes are
+        streamed: each 128x128 tile of the output goes through all of them, with every input area grown by that
+        effect's halo, while the tile's buffers are still in the CPU cache. Everything else runs at full size
+        first and the tiles read it from the caches, as does any node whose halo would make each tile several
+        times larger. Threads take tiles from a shared counter as they finish the previous one.
+
+        Some nodes only ever have their alpha channel read: the input to a shadow, the mask of an alpha mask, and
+        anything that reaches those only through blurs, transforms, crops or the first input of an alpha mask.
+        Those nodes store an AlphaBuffer instead of a full PixelBuffer, which cuts their memory and the memory
+        traffic of every kernel that touches them to a quarter. Luminance to alpha always stores its output that
+        way, since its color channels are always zero; consumers that need color expand alpha-only outputs to
+        black pixels as they read them.
+
+        Effect types without a software kernel pass their first input through unchanged.
+
+    */
+    struct EffectCache
+    {
+        uint64_t effectVersion = 0;
+        std::vector<uint64_t> inputGenerations;
+        uint64_t generation = 0;
+        bool alphaOnly = false; // which of output and alphaOutput holds the result
+        bool transient = false; // the output changed since the last render, so it isn't kept once it's been read
+        PixelBuffer output;
+        AlphaBuffer alphaOutput;
+    };
+
+    struct EffectRenderer
+    {
+        void render(Effect& effect, juce::Image& outputImage, juce::AffineTransform const& transform, bool clearDestination,
+            juce::RectangleList<int> dirtyRegion)
+        {
+            dirtyRegion.clipTo(outputImage.getBounds());
+            if (dirtyRegion.isEmpty())
+                return;
+
+            buildGraph(effect);
+            renderGraph(outputImage, transform, clearDestination, std::move(dirtyRegion));
+        }
+
+        /**
+         * Builds the graph once so it can be rendered many times with renderCompiled
+         */
+        void compile(Effect& effect)
+        {
+            buildGraph(effect);
+        }
+
+        /**
+         * Renders the graph built by compile. Property changes and new input images are patched into the existing
+         * nodes; the graph is only built again if an effect has been connected to a different input effect.
+         */
+        void renderCompiled(Effect& effect, juce::Image& outputImage, juce::AffineTransform const& transform, bool clearDestination,
+            juce::RectangleList<int> dirtyRegion)
+        {
+            dirtyRegion.clipTo(outputImage.getBounds());
+            if (dirtyRegion.isEmpty())
+                return;
+
+            if (nodes.empty() || nodes.back().effect != &effect || !patchGraph())
+                buildGraph(effect);
+
+            renderGraph(outputImage, transform, clearDestination, std::move(dirtyRegion));
+        }
+
+    private:
+        void renderGraph(juce::Image& outputImage, juce::AffineTransform const& transform, bool clearDestination, juce::RectangleList<int> dirtyRegion)
+        {
+            //
+            // Each dirty rectangle is rendered separately, which re-runs the graph for every rectangle. If the
+            // rectangles cover most of their bounding box, one pass over the bounding box is cheaper.
+            //
+            int64_t dirtyArea = 0;
+            for (auto const& rectangle : dirtyRegion)
+                dirtyArea += (int64_t)rectangle.getWidth() * rectangle.getHeight();
+
+            auto dirtyBounds = dirtyRegion.getBounds();
+            if (dirtyArea * 2 >= (int64_t)dirtyBounds.getWidth() * dirtyBounds.getHeight())
+                dirtyRegion = dirtyBounds;
+
+            for (auto const& rectangle : dirtyRegion)
+                renderArea(outputImage, transform, clearDestination, rectangle);
+
+            BufferPool::getInstance().endRender();
+        }
+
+        void renderArea(juce::Image& outputImage, juce::AffineTransform const& transform, bool clearDestination, juce::Rectangle<int> targetArea)
+        {
+            if (ResampleKernels::isIntegerTranslation(transform))
+            {
+                auto offsetX = (int)transform.getTranslationX();
+                auto offsetY = (int)transform.getTranslationY();
+                auto sourceArea = targetArea.translated(-offsetX, -offsetY);
+
+                execute(sourceArea);
+
+                auto output = extractArea((int)nodes.size() - 1, sourceArea);
+                output.area = targetArea;
+                writeToImage(output, outputImage, clearDestination);
+                return;
+            }
+
+            auto sourceArea = targetArea.toFloat().transformedBy(transform.inverted()).getSmallestIntegerContainer().expanded(1);
+            sourceArea = sourceArea.getIntersection(nodes.back().bounds);
+            execute(sourceArea);
+
+            PixelBuffer output{ targetArea };
+            ResampleKernels::affineTransform(extractArea((int)nodes.size() - 1, sourceArea), output, transform, Effect::AffineTransform2D::linear, 1.0f, {});
+            writeToImage(output, outputImage, clearDestination);
+        }
+
+        struct Node
+        {
+            Effect* effect = nullptr;
+            EffectCache* cache = nullptr;
+            juce::Image image;
+            std::vector<int> inputs;
+            uint64_t inputVersion = 0; // the Effect's input version when inputs was resolved
+            int level = 0;
+            int numConsumers = 0;
+            int numPendingConsumers = 0;
+            int fusedInto = -1;
+            std::vector<int> fusedMembers;
+            bool alphaOnly = false; // no consumer reads the color channels
+            bool optimized = false; // built from the Effect's property values, so a property change means building again
+            std::optional<juce::AffineTransform> transform; // merged affine transforms; replaces the Effect's own matrix
+            std::optional<Color128> constantColor; // the output is this premultiplied color everywhere
+            std::vector<uint64_t> foldedVersions; // versions of the effects merged or folded into this node
+            juce::Rectangle<int> bounds;
+            juce::Rectangle<int> area;
+            PixelBuffer imagePixels;
+            AlphaBuffer imageAlpha;
+            Node const* borrowed = nullptr; // in a tile, the full-size node whose output this node reads
+            juce::Image::BitmapData const* imageData = nullptr; // in a tile, where a streamed image is read from
+
+            bool hasAlphaOutput() const noexcept
+            {
+                if (borrowed)
+                    return borrowed->hasAlphaOutput();
+
+                return cache ? cache->alphaOnly : alphaOnly;
+            }
+
+            PixelBuffer const& getOutput() const noexcept
+            {
+                if (borrowed)
+                    return borrowed->getOutput();
+
+                return cache ? cache->output : imagePixels;
+            }
+
+            AlphaBuffer const& getAlphaOutput() const noexcept
+            {
+                if (borrowed)
+                    return borrowed->getAlphaOutput();
+
+                return cache ? cache->alphaOutput : imageAlpha;
+            }
+        };
+
+        static constexpr int tileSize = 128;
+        static constexpr int64_t minimumTilesToStream = 4;
+        static constexpr int64_t maximumTileGrowth = 4;
+
+        std::vector<Node> nodes;
+        std::map<EffectCache const*, int> effectNodes;
+        std::map<juce::ImagePixelData const*, int> imageNodes;
+        std::vector<std::vector<size_t>> levels;
+        std::vector<bool> streamed;
+
+        //
+        // Effects that were left out, merged or folded while building, with the versions those decisions were
+        // made on. Holding them keeps them alive while patchGraph checks them.
+        //
+        std::vector<std::pair<Effect::Ptr, uint64_t>> foldedEffects;
+
+        //
+        // For each effect that was left out, the versions its consumers fold in instead. An image input has no
+        // generation of its own, so without these a consumer wouldn't see a new image set on an effect in between.
+        //
+        std::map<EffectCache const*, std::vector<uint64_t>> passThroughVersions;
+
+        //
+        // Crops left out because their rectangle held the whole input; the input's bounds can grow when an
+        // upstream property changes
+        //
+        std::vector<std::pair<int, juce::Rectangle<float>>> elidedCrops;
+
+        //==============================================================================
+        //
+        // Graph construction
+        //
+
+        void buildGraph(Effect& outputEffect)
+        {
+            nodes.clear();
+            effectNodes.clear();
+            imageNodes.clear();
+            foldedEffects.clear();
+            passThroughVersions.clear();
+            elidedCrops.clear();
+
+            addEffectNode(outputEffect, true);
+            removeDeadNodes();
+
+            for (auto& node : nodes)
+            {
+                for (auto inputIndex : node.inputs)
+                {
+                    if (inputIndex >= 0)
+                        ++nodes[(size_t)inputIndex].numConsumers;
+                }
+            }
+
+            planAlphaOnly();
+            groupLevels();
+        }
+
+        /**
+         * Groups the nodes by level; each level runs in parallel
+         */
+        void groupLevels()
+        {
+            levels.clear();
+            for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex)
+            {
+                auto level = (size_t)nodes[nodeIndex].level;
+                if (levels.size() <= level)
+                    levels.resize(level + 1);
+
+                levels[level].push_back(nodeIndex);
+            }
+        }
+
+        /**
+         * Brings a compiled graph up to date before rendering it again, and returns false if it has to be built
+         * again instead.
+         *
+         * Only nodes whose Effect has had an input set since the graph was built are checked. Consumers are checked
+         * before their inputs, so an upstream Effect is never touched after its consumer has let go of it. After
+         * that, every node's bounds and generation are refreshed to pick up property changes.
+         *
+         * The optimisations made while building only hold for the property values they were made with, so any
+         * change to an effect that was left out, merged or folded, or to a node built from merged or folded
+         * inputs, means building again.
+         */
+        bool patchGraph()
+        {
+            for (auto const& [effect, version] : foldedEffects)
+            {
+                if (effect->getVersion() != version)
+                    return false;
+            }
+
+            for (auto nodeIndex = nodes.size(); nodeIndex-- > 0;)
+            {
+                auto& node = nodes[nodeIndex];
+                if (!node.effect)
+                    continue;
+
+                if (node.optimized && node.effect->getVersion() != node.cache->effectVersion)
+                    return false;
+
+                if (node.effect->getInputVersion() == node.inputVersion)
+                    continue;
+
+                auto const& inputs = node.effect->getInputs();
+                if (inputs.size() != node.inputs.size())
+                    return false;
+
+                for (size_t slot = 0; slot < inputs.size(); ++slot)
+                {
+                    if (!patchInput(node, slot, inputs[slot]))
+                        return false;
+                }
+
+                node.inputVersion = node.effect->getInputVersion();
+            }
+
+            for (auto& node : nodes)
+                node.bounds = getBounds(node);
+
+            for (auto const& [inputIndex, cropRect] : elidedCrops)
+            {
+                if (!cropRect.contains(nodes[(size_t)inputIndex].bounds.toFloat()))
+                    return false;
+            }
+
+            for (auto& node : nodes)
+            {
+                if (node.effect)
+                    updateGeneration(node);
+            }
+
+            return true;
+        }
+
+        /**
+         * An input still connected to the same Effect or Image needs no change. A different Image can replace the
+         * old one in place if nothing else reads the old one and the new one isn't already in the graph.
+         */
+        bool patchInput(Node const& node, size_t slot, Effect::Input const& input)
+        {
+            auto inputIndex = node.inputs[slot];
+
+            if (auto otherEffect = std::get_if<Effect::Ptr>(&input); otherEffect && *otherEffect)
+                return inputIndex >= 0 && nodes[(size_t)inputIndex].cache == &(*otherEffect)->getSoftwareCache();
+
+            auto image = std::get_if<juce::Image>(&input);
+            if (!image || !image->isValid())
+                return inputIndex < 0;
+
+            if (inputIndex < 0 || nodes[(size_t)inputIndex].effect)
+                return false;
+
+            auto& imageNode = nodes[(size_t)inputIndex];
+            auto pixelData = image->getPixelData().get();
+            if (imageNode.image.getPixelData().get() == pixelData)
+                return true;
+
+            if (imageNode.numConsumers != 1 || imageNodes.find(pixelData) != imageNodes.end())
+                return false;
+
+            imageNodes.erase(imageNode.image.getPixelData().get());
+            imageNodes[pixelData] = inputIndex;
+            imageNode.image = *image;
+            return true;
+        }
+
+        /**
+         * Works out which nodes only have their alpha channel read. Every consumer comes after its inputs, so walking
+         * backwards visits all of a node's consumers before the node itself.
+         */
+        void planAlphaOnly()
+        {
+            std::vector<bool> needsColor(nodes.size(), false);
+            needsColor.back() = true;
+
+            for (auto nodeIndex = nodes.size(); nodeIndex-- > 0;)
+            {
+                auto& node = nodes[nodeIndex];
+                node.alphaOnly = canStoreAlphaOnly(node)
+                    && (!needsColor[nodeIndex] || (node.effect && node.effect->effectType == Effect::Type::luminanceToAlpha));
+
+                for (size_t slot = 0; slot < node.inputs.size(); ++slot)
+                {
+                    if (node.inputs[slot] >= 0 && inputNeedsColor(node, slot))
+                        needsColor[(size_t)node.inputs[slot]] = true;
+                }
+            }
+        }
+
+        static bool canStoreAlphaOnly(Node const& node) noexcept
+        {
+            if (!node.effect)
+                return true;
+
+            if (node.constantColor)
+                return false;
+
+            switch (node.effect->effectType)
+            {
+            case Effect::Type::gaussianBlur:
+            case Effect::Type::shadow:
+            case Effect::Type::affineTransform2D:
+            case Effect::Type::perspectiveTransform3D:
+            case Effect::Type::crop:
+            case Effect::Type::alphaMask:
+            case Effect::Type::luminanceToAlpha:
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        static bool inputNeedsColor(Node const& node, size_t slot) noexcept
+        {
+            switch (node.effect->effectType)
+            {
+            case Effect::Type::shadow:
+            case Effect::Type::spotDiffuseLighting:
+            case Effect::Type::spotSpecularLighting:
+                return false;
+
+            case Effect::Type::alphaMask:
+                return slot == 0 && !node.alphaOnly;
+
+            case Effect::Type::gaussianBlur:
+            case Effect::Type::affineTransform2D:
+            case Effect::Type::perspectiveTransform3D:
+            case Effect::Type::crop:
+                return !node.alphaOnly;
+
+            default:
+                return true;
+            }
+        }
+
+        int addEffectNode(Effect& effect, bool isOutput = false)
+        {
+            //
+            // Effect objects that share a Pimpl also share a cache, so dedupe on the cache rather than the Effect
+            //
+            auto cache = &effect.getSoftwareCache();
+            if (auto existing = effectNodes.find(cache); existing != effectNodes.end())
+            {
+                //
+                // A node that's still being built is its own ancestor; break the cycle by treating that input as empty
+                //
+                jassert(existing->second >= 0);
+                return existing->second;
+            }
+
+            effectNodes[cache] = -1;
+
+            Node node;
+            node.effect = &effect;
+            node.cache = cache;
+            node.inputVersion = effect.getInputVersion();
+            for (auto const& input : effect.getInputs())
+            {
+                auto inputIndex = -1;
+                if (auto image = std::get_if<juce::Image>(&input); image && image->isValid())
+                    inputIndex = addImageNode(*image);
+                else if (auto otherEffect = std::get_if<Effect::Ptr>(&input); otherEffect && *otherEffect)
+                {
+                    inputIndex = addEffectNode(*otherEffect->get());
+
+                    if (auto passThrough = passThroughVersions.find(&(*otherEffect)->getSoftwareCache()); passThrough != passThroughVersions.end())
+                        node.foldedVersions.insert(node.foldedVersions.end(), passThrough->second.begin(), passThrough->second.end());
+                }
+
+                node.inputs.push_back(inputIndex);
+            }
+
+            //
+            // An effect that passes an input through hands its consumers that input's node instead. The output node
+            // always stays, so a compiled graph still ends with it.
+            //
+            if (auto passThrough = optimizeNode(node, isOutput); passThrough >= 0)
+            {
+                foldedEffects.emplace_back(Effect::Ptr{ &effect }, effect.getVersion());
+                node.foldedVersions.push_back(effect.getVersion());
+                passThroughVersions[cache] = std::move(node.foldedVersions);
+                effectNodes[cache] = passThrough;
+                return passThrough;
+            }
+
+            for (auto inputIndex : node.inputs)
+            {
+                if (inputIndex >= 0)
+                    node.level = juce::jmax(node.level, nodes[(size_t)inputIndex].level + 1);
+            }
+
+            auto index = (int)nodes.size();
+            nodes.emplace_back(std::move(node));
+            nodes.back().bounds = getBounds(nodes.back());
+            updateGeneration(nodes.back());
+            effectNodes[cache] = index;
+            return index;
+        }
+
+        /**
+         * Keeps the node's cached output if neither the effect nor any of its inputs have changed since it was computed;
+         * otherwise discards it and gives the node a new generation so the change carries on downstream
+         */
+        void updateGeneration(Node& node)
+        {
+            static std::atomic<uint64_t> nextGeneration = 1;
+
+            std::vector<uint64_t> inputGenerations;
+            for (auto inputIndex : node.inputs)
+            {
+                auto inputCache = inputIndex >= 0 ? nodes[(size_t)inputIndex].cache : nullptr;
+                inputGenerations.push_back(inputCache ? inputCache->generation : 0);
+            }
+
+            inputGenerations.insert(inputGenerations.end(), node.foldedVersions.begin(), node.foldedVersions.end());
+
+            auto& cache = *node.cache;
+            auto effectVersion = node.effect->getVersion();
+            if (cache.generation != 0 && cache.effectVersion == effectVersion && cache.inputGenerations == inputGenerations)
+            {
+                cache.transient = false;
+                return;
+            }
+
+            cache.transient = cache.generation != 0;
+            cache.effectVersion = effectVersion;
+            cache.inputGenerations = std::move(inputGenerations);
+            cache.generation = nextGeneration++;
+            cache.output = {};
+            cache.alphaOutput = {};
+        }
+
+        int addImageNode(juce::Image const& image)
+        {
+            auto pixelData = image.getPixelData().get();
+            if (auto existing = imageNodes.find(pixelData); existing != imageNodes.end())
+                return existing->second;
+
+            Node node;
+            node.image = image;
+            node.bounds = image.getBounds();
+
+            auto index = (int)nodes.size();
+            nodes.emplace_back(std::move(node));
+            imageNodes[pixelData] = index;
+            return index;
+        }
+
+        //==============================================================================
+        //
+        // Graph optimisation
+        //
+
+        /**
+         * Simplifies a node whose inputs have all been added. Returns the index of an input node that can stand in
+         * for the node, or -1 if the node still has to be added.
+         */
+        int optimizeNode(Node& node, bool isOutput)
+        {
+            switch (node.effect->effectType)
+            {
+            case Effect::Type::affineTransform2D:
+                mergeTransforms(node);
+                break;
+
+            case Effect::Type::composite:
+                dropHiddenInputs(node);
+                break;
+
+            default:
+                break;
+            }
+
+            if (!isOutput)
+            {
+                if (auto slot = getPassThroughSlot(node); slot >= 0 && slot < (int)node.inputs.size() && node.inputs[(size_t)slot] >= 0)
+                {
+                    auto inputIndex = node.inputs[(size_t)slot];
+                    if (node.effect->effectType == Effect::Type::crop)
+                        elidedCrops.emplace_back(inputIndex, getCropRect(*node.effect));
+
+                    return inputIndex;
+                }
+            }
+
+            foldConstant(node);
+            return -1;
+        }
+
+        /**
+         * The input slot whose pixels the node passes through unchanged, or -1
+         */
+        int getPassThroughSlot(Node const& node) const
+        {
+            auto& effect = *node.effect;
+
+            switch (effect.effectType)
+            {
+            case Effect::Type::affineTransform2D:
+                return isNearlyIdentity(getTransform(node)) ? 0 : -1;
+
+            case Effect::Type::gaussianBlur:
+                return getProperty<float>(effect, Effect::GaussianBlur::standardDeviation) <= 0.0f ? 0 : -1;
+
+            case Effect::Type::crop:
+            {
+                auto inputBounds = getInputBounds(node, 0);
+                return !inputBounds.isEmpty() && getCropRect(effect).contains(inputBounds.toFloat()) ? 0 : -1;
+            }
+
+            case Effect::Type::arithmeticComposite:
+            {
+                //
+                // Premultiplied inputs are already within 0 to 1, so clamping makes no difference
+                //
+                auto coefficients = getProperty<Vector4>(effect, Effect::ArithmeticComposite::coefficients);
+                if (coefficients[0] != 0.0f || coefficients[3] != 0.0f)
+                    return -1;
+
+                if (coefficients[1] == 1.0f && coefficients[2] == 0.0f)
+                    return 0;
+
+                if (coefficients[1] == 0.0f && coefficients[2] == 1.0f)
+                    return 1;
+
+                return -1;
+            }
+
+            case Effect::Type::composite:
+                return node.inputs.size() == 1 ? 0 : -1;
+
+            default:
+                return -1;
+            }
+        }
+
+        /**
+         * An affine transform reading another affine transform resamples the original input once with both
+         * matrices combined. Hard borders clip to the input between the two transforms, so they're left alone.
+         */
+        void mergeTransforms(Node& node)
+        {
+            auto inputIndex = node.inputs.empty() ? -1 : node.inputs.front();
+            if (inputIndex < 0)
+                return;
+
+            auto& input = nodes[(size_t)inputIndex];
+            if (!input.effect || input.effect->effectType != Effect::Type::affineTransform2D)
+                return;
+
+            auto& effect = *node.effect;
+            auto& inputEffect = *input.effect;
+            if (getProperty<int>(effect, Effect::AffineTransform2D::borderMode) != Effect::AffineTransform2D::soft
+                || getProperty<int>(inputEffect, Effect::AffineTransform2D::borderMode) != Effect::AffineTransform2D::soft
+                || getProperty<int>(effect, Effect::AffineTransform2D::interpolationMode) != getProperty<int>(inputEffect, Effect::AffineTransform2D::interpolationMode)
+                || getProperty<float>(effect, Effect::AffineTransform2D::sharpness) != getProperty<float>(inputEffect, Effect::AffineTransform2D::sharpness))
+            {
+                return;
+            }
+
+            node.transform = getTransform(input).followedBy(getTransform(node));
+            node.inputs = input.inputs;
+            foldInto(node, input);
+        }
+
+        /**
+         * In source over mode, anything composited before an opaque fill is covered by it, and a transparent fill or
+         * an unconnected input adds nothing
+         */
+        void dropHiddenInputs(Node& node)
+        {
+            if (getProperty<int>(*node.effect, Effect::Composite::mode) != Effect::Composite::sourceOver)
+                return;
+
+            std::vector<int> inputs;
+            for (size_t slot = 0; slot < node.inputs.size(); ++slot)
+            {
+                auto inputIndex = node.inputs[slot];
+                auto const* constantColor = inputIndex >= 0 ? &nodes[(size_t)inputIndex].constantColor : nullptr;
+
+                if (slot > 0 && (inputIndex < 0 || (*constantColor && isTransparent(**constantColor))))
+                {
+                    if (inputIndex >= 0)
+                        foldedEffects.emplace_back(Effect::Ptr{ nodes[(size_t)inputIndex].effect }, nodes[(size_t)inputIndex].effect->getVersion());
+                    continue;
+                }
+
+                if (slot > 0 && *constantColor && (*constantColor)->alpha >= 1.0f)
+                {
+                    foldedEffects.emplace_back(Effect::Ptr{ nodes[(size_t)inputIndex].effect }, nodes[(size_t)inputIndex].effect->getVersion());
+                    inputs.clear();
+                }
+
+                inputs.push_back(inputIndex);
+            }
+
+            if (inputs != node.inputs)
+            {
+                node.inputs = std::move(inputs);
+                node.optimized = true;
+            }
+        }
+
+        /**
+         * A point-wise effect whose inputs are all constant has a constant output. It's worked out by running the
+         * effect's fused kernel for a single pixel, and the node becomes a solid fill with no inputs.
+         */
+        void foldConstant(Node& node)
+        {
+            auto& effect = *node.effect;
+            if (!isPointwise(effect.effectType))
+                return;
+
+            //
+            // The dissolve pattern depends on the pixel position
+            //
+            if (effect.effectType == Effect::Type::blend && getProperty<int>(effect, Effect::Blend::mode) == Effect::Blend::dissolve)
+                return;
+
+            for (auto inputIndex : node.inputs)
+            {
+                if (inputIndex >= 0 && !nodes[(size_t)inputIndex].constantColor)
+                    return;
+            }
+
+            FusedEffectKernel kernel;
+            auto resultRegister = addFusedNode(kernel, node, (int)nodes.size());
+            PixelBuffer pixel{ { 0, 0, 1, 1 } };
+            kernel.run(pixel, resultRegister);
+
+            for (auto inputIndex : node.inputs)
+            {
+                if (inputIndex >= 0)
+                    foldInto(node, nodes[(size_t)inputIndex]);
+            }
+
+            node.inputs.clear();
+            node.constantColor = pixel.pixels.front();
+            node.optimized = true;
+        }
+
+        /**
+         * Records that the node now includes the input's effect, so a change to that effect invalidates the node and
+         * rebuilds a compiled graph
+         */
+        void foldInto(Node& node, Node const& input)
+        {
+            auto version = input.effect->getVersion();
+            node.foldedVersions.insert(node.foldedVersions.end(), input.foldedVersions.begin(), input.foldedVersions.end());
+            node.foldedVersions.push_back(version);
+            node.optimized = true;
+            foldedEffects.emplace_back(Effect::Ptr{ input.effect }, version);
+        }
+
+        /**
+         * Removes nodes that no longer lead to the output now that their consumers have been merged or folded
+         */
+        void removeDeadNodes()
+        {
+            std::vector<bool> live(nodes.size(), false);
+            live.back() = true;
+            for (auto nodeIndex = nodes.size(); nodeIndex-- > 0;)
+            {
+                if (!live[nodeIndex])
+                    continue;
+
+                for (auto inputIndex : nodes[nodeIndex].inputs)
+                {
+                    if (inputIndex >= 0)
+                        live[(size_t)inputIndex] = true;
+                }
+            }
+
+            if (std::find(live.begin(), live.end(), false) == live.end())
+                return;
+
+            std::vector<int> newIndices(nodes.size(), -1);
+            size_t numLive = 0;
+            for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex)
+            {
+                if (!live[nodeIndex])
+                    continue;
+
+                newIndices[nodeIndex] = (int)numLive;
+                if (numLive != nodeIndex)
+                    nodes[numLive] = std::move(nodes[nodeIndex]);
+
+                ++numLive;
+            }
+
+            nodes.resize(numLive);
+            for (auto& node : nodes)
+            {
+                for (auto& inputIndex : node.inputs)
+                {
+                    if (inputIndex >= 0)
+                        inputIndex = newIndices[(size_t)inputIndex];
+                }
+            }
+
+            auto remap = [&](auto& indexMap)
+                {
+                    for (auto entry = indexMap.begin(); entry != indexMap.end();)
+                    {
+                        if (auto newIndex = newIndices[(size_t)entry->second]; newIndex >= 0)
+                        {
+                            entry->second = newIndex;
+                            ++entry;
+                        }
+                        else
+                        {
+                            entry = indexMap.erase(entry);
+                        }
+                    }
+                };
+
+            remap(effectNodes);
+            remap(imageNodes);
+
+            std::vector<std::pair<int, juce::Rectangle<float>>> liveCrops;
+            for (auto const& [inputIndex, cropRect] : elidedCrops)
+            {
+                if (newIndices[(size_t)inputIndex] >= 0)
+                    liveCrops.emplace_back(newIndices[(size_t)inputIndex], cropRect);
+            }
+
+            elidedCrops = std::move(liveCrops);
+        }
+
+        static bool isNearlyIdentity(juce::AffineTransform const& transform) noexcept
+        {
+            constexpr float scaleTolerance = 1.0e-6f;
+            constexpr float translationTolerance = 1.0e-4f;
+
+            return std::abs(transform.mat00 - 1.0f) < scaleTolerance && std::abs(transform.mat01) < scaleTolerance
+                && std::abs(transform.mat10) < scaleTolerance && std::abs(transform.mat11 - 1.0f) < scaleTolerance
+                && std::abs(transform.mat02) < translationTolerance && std::abs(transform.mat12) < translationTolerance;
+        }
+
+        static bool isTransparent(Color128 color) noexcept
+        {
+            return color.red == 0.0f && color.green == 0.0f && color.blue == 0.0f && color.alpha == 0.0f;
+        }
+
+        //==============================================================================
+        //
+        // Execution
+        //
+
+        void execute(juce::Rectangle<int> outputArea)
+        {
+            //
+            // Propagate the requested areas from the output back towards the inputs
+            //
+            for (auto& node : nodes)
+                node.area = {};
+
+            nodes.back().area = outputArea.getIntersection(nodes.back().bounds);
+
+            for (auto nodeIndex = nodes.size(); nodeIndex-- > 0;)
+            {
+                auto& node = nodes[nodeIndex];
+                node.numPendingConsumers = node.numConsumers;
+                if (node.area.isEmpty() || node.borrowed || isCached(node))
+                    continue;
+
+                for (size_t slot = 0; slot < node.inputs.size(); ++slot)
+                {
+                    if (node.inputs[slot] < 0)
+                        continue;
+
+                    auto& input = nodes[(size_t)node.inputs[slot]];
+                    auto inputArea = getInputArea(node, slot, node.area).getIntersection(input.bounds);
+                    input.area = input.area.getUnion(inputArea);
+                }
+            }
+
+            //
+            // Streamed nodes are left out of the full-size pass and run tile by tile once everything they read is ready
+            //
+            streamed = planStreaming();
+            auto streamedArea = nodes.back().area;
+            for (size_t nodeIndex = 0; nodeIndex < streamed.size(); ++nodeIndex)
+            {
+                if (streamed[nodeIndex])
+                    nodes[nodeIndex].area = {};
+            }
+
+            planFusion();
+
+            for (auto const& level : levels)
+            {
+                parallelFor((int)level.size(), [&](int index)
+                    {
+                        evaluateNode(nodes[level[(size_t)index]]);
+                    });
+
+                //
+                // Release any input images and transient effect outputs that have no consumers left; other effect
+                // outputs stay in their caches. Fused nodes read their inputs when the last node of the chain runs,
+                // so they're released along with it.
+                //
+                for (auto nodeIndex : level)
+                {
+                    auto const& node = nodes[nodeIndex];
+                    if (node.fusedInto >= 0 || isStreamed(nodeIndex))
+                        continue;
+
+                    releaseInputs(node);
+                    for (auto memberIndex : node.fusedMembers)
+                        releaseInputs(nodes[(size_t)memberIndex]);
+                }
+            }
+
+            if (!streamed.empty())
+            {
+                executeTiles(streamedArea);
+
+                for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex)
+                {
+                    if (streamed[nodeIndex])
+                        releaseInputs(nodes[nodeIndex]);
+                }
+            }
+        }
+
+        //==============================================================================
+        //
+        // Tiled execution
+        //
+
+        bool isStreamed(size_t nodeIndex) const noexcept
+        {
+            return nodeIndex < streamed.size() && streamed[nodeIndex];
+        }
+
+        /**
+         * Picks the nodes to run one tile at a time, or returns an empty list if this render isn't worth tiling.
+         *
+         * Only transient nodes are streamed; a full-size output for anything else is worth keeping in its cache.
+         * Every consumer of a streamed node has to be streamed too, since the node never has a full-size output for
+         * anything else to read. A node also stays at full size if the area one tile needs from it (halo included)
+         * is more than maximumTileGrowth tiles, which keeps a wide blur or a strong downscale from being run again
+         * for every tile.
+         */
+        std::vector<bool> planStreaming() const
+        {
+            auto const& output = nodes.back();
+            auto tileArea = (int64_t)tileSize * tileSize;
+            if ((int64_t)output.area.getWidth() * output.area.getHeight() < minimumTilesToStream * tileArea || !canStream(output))
+                return {};
+
+            std::vector<bool> result(nodes.size(), false);
+            std::vector<int> numStreamedConsumers(nodes.size(), 0);
+            std::vector<juce::Rectangle<int>> tileAreas(nodes.size());
+            tileAreas.back() = output.area.withSize(tileSize, tileSize);
+
+            for (auto nodeIndex = nodes.size(); nodeIndex-- > 0;)
+            {
+                auto const& node = nodes[nodeIndex];
+                auto const& area = tileAreas[nodeIndex];
+                result[nodeIndex] = nodeIndex + 1 == nodes.size()
+                    || (numStreamedConsumers[nodeIndex] == node.numConsumers && canStream(node)
+                        && (int64_t)area.getWidth() * area.getHeight() <= maximumTileGrowth * tileArea);
+
+                if (!result[nodeIndex])
+                    continue;
+
+                for (size_t slot = 0; slot < node.inputs.size(); ++slot)
+                {
+                    if (node.inputs[slot] < 0)
+                        continue;
+
+                    auto inputIndex = (size_t)node.inputs[slot];
+                    tileAreas[inputIndex] = tileAreas[inputIndex].getUnion(getInputArea(node, slot, area).getIntersection(nodes[inputIndex].bounds));
+                    ++numStreamedConsumers[inputIndex];
+                }
+            }
+
+            return result;
+        }
+
+        static bool canStream(Node const& node) noexcept
+        {
+            if (node.area.isEmpty())
+                return false;
+
+            return !node.effect || (node.cache->transient && !isCached(node));
+        }
+
+        /**
+         * Runs the streamed nodes for each tile of the area in turn, while the tile's intermediate buffers still fit
+         * in the CPU cache. Each tile gets its own lightweight copy of the graph: streamed nodes write to caches that
+         * belong to the tile and are released as soon as the tile no longer needs them, and every other node is
+         * borrowed from the full-size pass. Tiles are handed out to whichever thread is free, and everything inside a
+         * tile runs on that one thread.
+         */
+        void executeTiles(juce::Rectangle<int> area)
+        {
+            //
+            // Streamed images are read a tile at a time from one BitmapData each, opened here on the calling thread
+            //
+            std::vector<std::unique_ptr<juce::Image::BitmapData>> imageData(nodes.size());
+            for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex)
+            {
+                if (streamed[nodeIndex] && !nodes[nodeIndex].effect)
+                    imageData[nodeIndex] = std::make_unique<juce::Image::BitmapData>(nodes[nodeIndex].image, juce::Image::BitmapData::readOnly);
+            }
+
+            auto& output = nodes.back();
+            auto& cache = *output.cache;
+            cache.alphaOnly = output.alphaOnly;
+            cache.output = {};
+            cache.alphaOutput = {};
+            if (output.alphaOnly)
+                cache.alphaOutput = AlphaBuffer{ area };
+            else
+                cache.output = PixelBuffer{ area };
+
+            auto numColumns = (area.getWidth() + tileSize - 1) / tileSize;
+            auto numRows = (area.getHeight() + tileSize - 1) / tileSize;
+            parallelFor(numColumns * numRows, [&](int tileIndex)
+                {
+                    ScopedSerialLoops serialLoops;
+
+                    auto tile = juce::Rectangle<int>{ area.getX() + (tileIndex % numColumns) * tileSize, area.getY() + (tileIndex / numColumns) * tileSize, tileSize, tileSize }
+                        .getIntersection(area);
+
+                    EffectRenderer tileRenderer;
+                    tileRenderer.levels = levels;
+                    std::vector<EffectCache> tileCaches(nodes.size());
+                    tileRenderer.nodes.reserve(nodes.size());
+                    for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex)
+                    {
+                        auto const& node = nodes[nodeIndex];
+                        auto& copy = tileRenderer.nodes.emplace_back();
+                        copy.effect = node.effect;
+                        copy.inputs = node.inputs;
+                        copy.level = node.level;
+                        copy.numConsumers = node.numConsumers;
+                        copy.alphaOnly = node.alphaOnly;
+                        copy.transform = node.transform;
+                        copy.constantColor = node.constantColor;
+                        copy.bounds = node.bounds;
+
+                        if (!streamed[nodeIndex])
+                            copy.borrowed = &node;
+                        else if (!node.effect)
+                            copy.imageData = imageData[nodeIndex].get();
+                        else
+                        {
+                            copy.cache = &tileCaches[nodeIndex];
+                            copy.cache->transient = true;
+                        }
+                    }
+
+                    tileRenderer.execute(tile);
+
+                    auto const& tileOutput = tileRenderer.nodes.back();
+                    if (output.alphaOnly)
+                        EffectKernels::copy(tileOutput.getAlphaOutput(), cache.alphaOutput);
+                    else
+                        EffectKernels::copy(tileOutput.getOutput(), cache.output);
+                });
+        }
+
+        void releaseInputs(Node const& node)
+        {
+            for (auto inputIndex : node.inputs)
+            {
+                if (inputIndex < 0)
+                    continue;
+
+                auto& input = nodes[(size_t)inputIndex];
+                if (--input.numPendingConsumers == 0 && !input.borrowed)
+                {
+                    input.imagePixels = {};
+                    input.imageAlpha = {};
+
+                    if (input.cache && input.cache->transient)
+                    {
+                        input.cache->output = {};
+                        input.cache->alphaOutput = {};
+                    }
+                }
+            }
+        }
+
+        /**
+         * A cached color output can stand in for an alpha-only node, but not the other way round
+         */
+        static bool isCached(Node const& node) noexcept
+        {
+            if (!node.cache)
+                return false;
+
+            if (node.cache->alphaOnly)
+                return node.alphaOnly && node.cache->alphaOutput.area.contains(node.area);
+
+            return node.cache->output.area.contains(node.area);
+        }
+
+        //==============================================================================
+        //
+        // Fusion of point-wise effects
+        //
+
+        static bool isPointwise(Effect::Type type) noexcept
+        {
+            switch (type)
+            {
+            case Effect::Type::flood:
+            case Effect::Type::invert:
+            case Effect::Type::luminanceToAlpha:
+            case Effect::Type::alphaMask:
+            case Effect::Type::arithmeticComposite:
+            case Effect::Type::blend:
+            case Effect::Type::composite:
+            case Effect::Type::chromaKey:
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        static bool canFuse(Node const& node) noexcept
+        {
+            return node.effect && isPointwise(node.effect->effectType) && !node.area.isEmpty() && !node.borrowed && !isCached(node);
+        }
+
+        /**
+         * Groups chains of point-wise effects so each chain runs as a single FusedEffectKernel. A point-wise node
+         * joins its consumer's chain if the consumer is also point-wise and is the only thing reading its output;
+         * the chain runs when its last node runs, and the other nodes in the chain are skipped.
+         */
+        void planFusion()
+        {
+            for (auto& node : nodes)
+            {
+                node.fusedInto = -1;
+                node.fusedMembers.clear();
+            }
+
+            for (auto nodeIndex = nodes.size(); nodeIndex-- > 0;)
+            {
+                auto& node = nodes[nodeIndex];
+                if (!canFuse(node))
+                    continue;
+
+                auto chainEnd = node.fusedInto >= 0 ? node.fusedInto : (int)nodeIndex;
+                for (auto inputIndex : node.inputs)
+                {
+                    if (inputIndex < 0)
+                        continue;
+
+                    auto& input = nodes[(size_t)inputIndex];
+                    if (input.numConsumers == 1 && input.fusedInto < 0 && canFuse(input))
+                    {
+                        input.fusedInto = chainEnd;
+                        nodes[(size_t)chainEnd].fusedMembers.push_back(inputIndex);
+                    }
+                }
+            }
+        }
+
+        void evaluateFused(Node& node)
+        {
+            FusedEffectKernel kernel;
+            auto chainEnd = (int)(&node - nodes.data());
+            auto resultRegister = addFusedNode(kernel, node, chainEnd);
+
+            auto& cache = *node.cache;
+            cache.alphaOnly = node.alphaOnly;
+            cache.output = PixelBuffer{ node.area };
+            kernel.run(cache.output, resultRegister);
+
+            if (node.alphaOnly)
+            {
+                cache.alphaOutput = AlphaBuffer{ node.area };
+                EffectKernels::extractAlpha(cache.output, cache.alphaOutput);
+                cache.output = {};
+            }
+        }
+
+        /**
+         * Adds the operations for a node in the chain to the kernel and returns the register that holds its output
+         */
+        int addFusedNode(FusedEffectKernel& kernel, Node const& node, int chainEnd) const
+        {
+            auto& effect = *node.effect;
+
+            FusedEffectKernel::Operation operation;
+            operation.type = effect.effectType;
+
+            if (node.constantColor)
+            {
+                operation.type = Effect::Type::flood;
+                operation.target = kernel.addRegister();
+                operation.color = *node.constantColor;
+                kernel.addOperation(operation);
+                return operation.target;
+            }
+
+            switch (effect.effectType)
+            {
+            case Effect::Type::flood:
+                operation.target = kernel.addRegister();
+                operation.color = premultiplied(toColor(getProperty<Vector4>(effect, Effect::Flood::color)));
+                break;
+
+            case Effect::Type::alphaMask:
+                operation.target = addFusedInput(kernel, node, 0, chainEnd);
+                operation.other = addFusedInput(kernel, node, 1, chainEnd);
+                break;
+
+            case Effect::Type::arithmeticComposite:
+                operation.target = addFusedInput(kernel, node, 0, chainEnd);
+                operation.other = addFusedInput(kernel, node, 1, chainEnd);
+                operation.coefficients = getProperty<Vector4>(effect, Effect::ArithmeticComposite::coefficients);
+                operation.clampOutput = getProperty<bool>(effect, Effect::ArithmeticComposite::clampOutput);
+                break;
+
+            case Effect::Type::blend:
+                operation.target = addFusedInput(kernel, node, 0, chainEnd);
+                operation.other = addFusedInput(kernel, node, 1, chainEnd);
+                operation.mode = getProperty<int>(effect, Effect::Blend::mode);
+                break;
+
+            case Effect::Type::chromaKey:
+                operation.target = addFusedInput(kernel, node, 0, chainEnd);
+                operation.chromaKey = getChromaKey(effect);
+                break;
+
+            case Effect::Type::composite:
+            {
+                //
+                // Composite each remaining input onto input 0 in turn
+                //
+                operation.target = addFusedInput(kernel, node, 0, chainEnd);
+                operation.mode = getProperty<int>(effect, Effect::Composite::mode);
+                for (size_t slot = 1; slot < node.inputs.size(); ++slot)
+                {
+                    operation.other = addFusedInput(kernel, node, slot, chainEnd);
+                    operation.sourceBounds = getInputBounds(node, slot);
+                    kernel.addOperation(operation);
+                }
+
+                return operation.target;
+            }
+
+            default:
+                operation.target = addFusedInput(kernel, node, 0, chainEnd);
+                break;
+            }
+
+            kernel.addOperation(operation);
+            return operation.target;
+        }
+
+        int addFusedInput(FusedEffectKernel& kernel, Node const& node, size_t slot, int chainEnd) const
+        {
+            auto inputIndex = slot < node.inputs.size() ? node.inputs[slot] : -1;
+            if (inputIndex < 0)
+                return kernel.addLoad(nullptr);
+
+            //
+            // A constant input is cheaper to fill into a register than to load
+            //
+            auto const& input = nodes[(size_t)inputIndex];
+            if (input.fusedInto == chainEnd || input.constantColor)
+                return addFusedNode(kernel, input, chainEnd);
+
+            if (input.hasAlphaOutput())
+                return kernel.addLoad(input.getAlphaOutput());
+
+            return kernel.addLoad(&input.getOutput());
+        }
+
+        /**
+         * Returns a buffer covering exactly the requested area of the node's output, transparent where the node has
+         * no pixels. A node index of -1 is an unconnected input.
+         *
+         * Alpha-only outputs are expanded to black pixels for a PixelBuffer; color outputs have their alpha
+         * channel extracted for an AlphaBuffer.
+         */
+        template <typename Sample = Color128>
+        ImageBuffer<Sample> extractArea(int nodeIndex, juce::Rectangle<int> area) const
+        {
+            ImageBuffer<Sample> buffer{ area };
+            if (nodeIndex < 0)
+                return buffer;
+
+            auto const& node = nodes[(size_t)nodeIndex];
+            if constexpr (std::is_same_v<Sample, float>)
+            {
+                if (node.hasAlphaOutput())
+                    EffectKernels::copy(node.getAlphaOutput(), buffer);
+                else
+                    EffectKernels::extractAlpha(node.getOutput(), buffer);
+            }
+            else
+            {
+                if (node.hasAlphaOutput())
+                    EffectKernels::expandAlpha(node.getAlphaOutput(), buffer);
+                else
+                    EffectKernels::copy(node.getOutput(), buffer);
+            }
+
+            return buffer;
+        }
+
+        template <typename Sample = Color128>
+        ImageBuffer<Sample> getInput(Node const& node, size_t slot, juce::Rectangle<int> area) const
+        {
+            return extractArea<Sample>(slot < node.inputs.size() ? node.inputs[slot] : -1, area);
+        }
+
+        juce::Rectangle<int> getInputBounds(Node const& node, size_t slot) const
+        {
+            if (slot >= node.inputs.size() || node.inputs[slot] < 0)
+                return {};
+
+            return nodes[(size_t)node.inputs[slot]].bounds;
+        }
+
+        void evaluateNode(Node& node)
+        {
+            auto area = node.area;
+            if (area.isEmpty())
+                return;
+
+            if (node.borrowed)
+                return;
+
+            if (node.imageData)
+            {
+                if (node.alphaOnly)
+                    node.imageAlpha = loadImageAlpha(*node.imageData, {}, area);
+                else
+                    node.imagePixels = loadImage(*node.imageData, {}, area);
+                return;
+            }
+
+            if (!node.effect)
+            {
+                if (node.alphaOnly)
+                    node.imageAlpha = loadImageAlpha(node.image, area);
+                else
+                    node.imagePixels = loadImage(node.image, area);
+                return;
+            }
+
+            if (node.fusedInto >= 0 || isCached(node))
+                return;
+
+            if (!node.fusedMembers.empty())
+            {
+                evaluateFused(node);
+                return;
+            }
+
+            auto& cache = *node.cache;
+            cache.alphaOnly = node.alphaOnly;
+            cache.output = {};
+            cache.alphaOutput = {};
+
+            if (node.alphaOnly)
+            {
+                cache.alphaOutput = AlphaBuffer{ area };
+                evaluateAlphaOnly(node, cache.alphaOutput);
+                return;
+            }
+
+            auto& result = cache.output;
+            auto& effect = *node.effect;
+            result = PixelBuffer{ area };
+
+            if (node.constantColor)
+            {
+                EffectKernels::flood(result, *node.constantColor);
+                return;
+            }
+
+            switch (effect.effectType)
+            {
+            case Effect::Type::flood:
+            {
+                EffectKernels::flood(result, premultiplied(toColor(getProperty<Vector4>(effect, Effect::Flood::color))));
+                break;
+            }
+
+            case Effect::Type::gaussianBlur:
+                gaussianBlur(node, result);
+                break;
+
+            case Effect::Type::shadow:
+            {
+                BlurKernels::shadow(getInput<float>(node, 0, getInputArea(node, 0, area)), result,
+                    getProperty<float>(effect, Effect::Shadow::blurStandardDeviation),
+                    getProperty<int>(effect, Effect::Shadow::optimization),
+                    premultiplied(toColor(getProperty<Vector4>(effect, Effect::Shadow::color))));
+                break;
+            }
+
+            case Effect::Type::affineTransform2D:
+                affineTransform(node, result);
+                break;
+
+            case Effect::Type::perspectiveTransform3D:
+                perspectiveTransform(node, result);
+                break;
+
+            case Effect::Type::crop:
+                crop(node, result);
+                break;
+
+            case Effect::Type::composite:
+            {
+                result = getInput(node, 0, area);
+                auto mode = getProperty<int>(effect, Effect::Composite::mode);
+                for (size_t slot = 1; slot < node.inputs.size(); ++slot)
+                {
+                    //
+                    // Only fetch the part of the source that can have pixels; the compositor treats the rest as transparent
+                    //
+                    auto sourceBounds = getInputBounds(node, slot);
+                    CompositeKernels::composite(result, getInput(node, slot, area.getIntersection(sourceBounds)), mode, sourceBounds);
+                }
+                break;
+            }
+
+            case Effect::Type::blend:
+            {
+                result = getInput(node, 0, area);
+                BlendKernels::blend(result, getInput(node, 1, area), getProperty<int>(effect, Effect::Blend::mode));
+                break;
+            }
+
+            case Effect::Type::arithmeticComposite:
+            {
+                result = getInput(node, 0, area);
+                EffectKernels::arithmeticComposite(result, getInput(node, 1, area),
+                    getProperty<Vector4>(effect, Effect::ArithmeticComposite::coefficients),
+                    getProperty<bool>(effect, Effect::ArithmeticComposite::clampOutput));
+                break;
+            }
+
+            case Effect::Type::alphaMask:
+                alphaMask(node, result);
+                break;
+
+            case Effect::Type::invert:
+            {
+                result = getInput(node, 0, area);
+                EffectKernels::invert(result);
+                break;
+            }
+
+            case Effect::Type::chromaKey:
+            {
+                result = getInput(node, 0, area);
+                ChromaKeyKernels::chromaKey(result, getChromaKey(effect));
+                break;
+            }
+
+            case Effect::Type::spotDiffuseLighting:
+            {
+                LightingKernels::spotDiffuse(getInput<float>(node, 0, getInputArea(node, 0, area)), result,
+                    getSpotLight(effect, Effect::SpotDiffuseLighting::color),
+                    getSurface(effect, Effect::SpotDiffuseLighting::surfaceScale, Effect::SpotDiffuseLighting::kernelUnitLength),
+                    getProperty<float>(effect, Effect::SpotDiffuseLighting::diffuseConstant));
+                break;
+            }
+
+            case Effect::Type::spotSpecularLighting:
+            {
+                LightingKernels::spotSpecular(getInput<float>(node, 0, getInputArea(node, 0, area)), result,
+                    getSpotLight(effect, Effect::SpotSpecularLighting::color),
+                    getSurface(effect, Effect::SpotSpecularLighting::surfaceScale, Effect::SpotSpecularLighting::kernelUnitLength),
+                    getProperty<float>(effect, Effect::SpotSpecularLighting::specularConstant),
+                    getProperty<float>(effect, Effect::SpotSpecularLighting::specularExponent));
+                break;
+            }
+
+            case Effect::Type::edgeDetect:
+            {
+                ConvolutionKernels::edgeDetect(getInput(node, 0, getInputArea(node, 0, area)), result,
+                    getProperty<float>(effect, Effect::EdgeDetection::strength),
+                    getProperty<float>(effect, Effect::EdgeDetection::blurRadius),
+                    getProperty<int>(effect, Effect::EdgeDetection::mode),
+                    getProperty<bool>(effect, Effect::EdgeDetection::overlayEdges));
+                break;
+            }
+
+            case Effect::Type::highlightsAndShadows:
+            {
+                ToneKernels::highlightsAndShadows(getInput(node, 0, getInputArea(node, 0, area)), result,
+                    getProperty<float>(effect, Effect::HighlightsAndShadows::highlights),
+                    getProperty<float>(effect, Effect::HighlightsAndShadows::shadows),
+                    getProperty<float>(effect, Effect::HighlightsAndShadows::clarity),
+                    getProperty<int>(effect, Effect::HighlightsAndShadows::inputGamma),
+                    getProperty<float>(effect, Effect::HighlightsAndShadows::maskBlurRadius));
+                break;
+            }
+
+            case Effect::Type::emboss:
+            {
+                ConvolutionKernels::emboss(getInput(node, 0, getInputArea(node, 0, area)), result,
+                    getProperty<float>(effect, Effect::Emboss::height),
+                    getProperty<float>(effect, Effect::Emboss::direction));
+                break;
+            }
+
+            default:
+            {
+                result = getInput(node, 0, area);
+                break;
+            }
+            }
+        }
+
+        /**
+         * Runs one of the effects that canStoreAlphaOnly allows for
+         */
+        void evaluateAlphaOnly(Node const& node, AlphaBuffer& result) const
+        {
+            auto& effect = *node.effect;
+
+            switch (effect.effectType)
+            {
+            case Effect::Type::gaussianBlur:
+                gaussianBlur(node, result);
+                break;
+
+            case Effect::Type::shadow:
+            {
+                BlurKernels::shadow(getInput<float>(node, 0, getInputArea(node, 0, result.area)), result,
+                    getProperty<float>(effect, Effect::Shadow::blurStandardDeviation),
+                    getProperty<int>(effect, Effect::Shadow::optimization),
+                    premultiplied(toColor(getProperty<Vector4>(effect, Effect::Shadow::color))).alpha);
+                break;
+            }
+
+            case Effect::Type::affineTransform2D:
+                affineTransform(node, result);
+                break;
+
+            case Effect::Type::perspectiveTransform3D:
+                perspectiveTransform(node, result);
+                break;
+
+            case Effect::Type::crop:
+                crop(node, result);
+                break;
+
+            case Effect::Type::alphaMask:
+                alphaMask(node, result);
+                break;
+
+            case Effect::Type::luminanceToAlpha:
+                EffectKernels::luminanceToAlpha(getInput(node, 0, result.area), result);
+                break;
+
+            default:
+                jassertfalse;
+                break;
+            }
+        }
+
+        //==============================================================================
+        //
+        // Effects that run on either color or alpha-only buffers
+        //
+
+        template <typename Sample>
+        void gaussianBlur(Node const& node, ImageBuffer<Sample>& result) const
+        {
+            auto& effect = *node.effect;
+
+            std::optional<juce::Rectangle<int>> hardEdge;
+            if (getProperty<int>(effect, Effect::GaussianBlur::borderMode) == Effect::GaussianBlur::hard)
+                hardEdge = getInputBounds(node, 0);
+
+            BlurKernels::gaussianBlur(getInput<Sample>(node, 0, getInputArea(node, 0, result.area)), result,
+                getProperty<float>(effect, Effect::GaussianBlur::standardDeviation),
+                getProperty<int>(effect, Effect::GaussianBlur::optimization), hardEdge);
+        }
+
+        template <typename Sample>
+        void affineTransform(Node const& node, ImageBuffer<Sample>& result) const
+        {
+            auto& effect = *node.effect;
+
+            auto transform = getTransform(node);
+            if (transform.isSingularity())
+                return;
+
+            auto inputBounds = getInputBounds(node, 0);
+            std::optional<juce::Rectangle<int>> hardEdge;
+            if (getProperty<int>(effect, Effect::AffineTransform2D::borderMode) == Effect::AffineTransform2D::hard)
+                hardEdge = inputBounds;
+
+            ResampleKernels::affineTransform(getInput<Sample>(node, 0, getInputArea(node, 0, result.area).getIntersection(inputBounds)), result, transform,
+                getProperty<int>(effect, Effect::AffineTransform2D::interpolationMode),
+                getProperty<float>(effect, Effect::AffineTransform2D::sharpness), hardEdge);
+        }
+
+        template <typename Sample>
+        void perspectiveTransform(Node const& node, ImageBuffer<Sample>& result) const
+        {
+            auto& effect = *node.effect;
+
+            auto inputBounds = getInputBounds(node, 0);
+            std::optional<juce::Rectangle<int>> hardEdge;
+            if (getProperty<int>(effect, Effect::PerspectiveTransform3D::borderMode) == Effect::PerspectiveTransform3D::hard)
+                hardEdge = inputBounds;
+
+            ResampleKernels::perspectiveTransform(getInput<Sample>(node, 0, getInputArea(node, 0, result.area).getIntersection(inputBounds)), result,
+                getPerspectiveProjection(effect), getProperty<int>(effect, Effect::PerspectiveTransform3D::interpolationMode), hardEdge);
+        }
+
+        template <typename Sample>
+        void crop(Node const& node, ImageBuffer<Sample>& result) const
+        {
+            auto& effect = *node.effect;
+
+            result = getInput<Sample>(node, 0, result.area);
+            EffectKernels::crop(result, getCropRect(effect), getProperty<int>(effect, Effect::Crop::borderMode) == Effect::Crop::hard);
+        }
+
+        template <typename Sample>
+        void alphaMask(Node const& node, ImageBuffer<Sample>& result) const
+        {
+            result = getInput<Sample>(node, 0, result.area);
+            EffectKernels::alphaMask(result, getInput<float>(node, 1, result.area));
+        }
+
+        //==============================================================================
+        //
+        // Per-effect geometry
+        //
+
+        /**
+         * The area of an input that the node needs in order to produce the given area of its output
+         */
+        static juce::Rectangle<int> getInputArea(Node const& node, [[maybe_unused]] size_t slot, juce::Rectangle<int> area)
+        {
+            auto& effect = *node.effect;
+
+            switch (effect.effectType)
+            {
+            case Effect::Type::gaussianBlur:
+                return area.expanded(BlurKernels::getBlurRadius(getProperty<float>(effect, Effect::GaussianBlur::standardDeviation)));
+
+            case Effect::Type::shadow:
+                return area.expanded(BlurKernels::getBlurRadius(getProperty<float>(effect, Effect::Shadow::blurStandardDeviation)));
+
+            case Effect::Type::affineTransform2D:
+            {
+                auto transform = getTransform(node);
+                if (transform.isSingularity())
+                    return {};
+
+                auto margin = ResampleKernels::getSourceMargin(transform, getProperty<int>(effect, Effect::AffineTransform2D::interpolationMode));
+                return area.toFloat().transformedBy(transform.inverted()).getSmallestIntegerContainer().expanded(margin);
+            }
+
+            case Effect::Type::perspectiveTransform3D:
+            {
+                auto projection = getPerspectiveProjection(effect);
+                if (projection.isSingular())
+                    return {};
+
+                //
+                // The multi-sample modes read up to half a destination pixel past each pixel center
+                //
+                auto margin = ResampleKernels::getPerspectiveMargin(getProperty<int>(effect, Effect::PerspectiveTransform3D::interpolationMode));
+                return ResampleKernels::getProjectedBounds(projection.inverted(), area.expanded(1), getUnboundedArea()).expanded(margin);
+            }
+
+            case Effect::Type::crop:
+                return area.getIntersection(getCropRect(effect).getSmallestIntegerContainer());
+
+            case Effect::Type::spotDiffuseLighting:
+            case Effect::Type::spotSpecularLighting:
+            case Effect::Type::emboss:
+                return area.expanded(1);
+
+            case Effect::Type::highlightsAndShadows:
+                return area.expanded(ToneKernels::getHighlightsAndShadowsMargin(getProperty<float>(effect, Effect::HighlightsAndShadows::maskBlurRadius)));
+
+            case Effect::Type::edgeDetect:
+                return area.expanded(ConvolutionKernels::getEdgeDetectRadius(getProperty<float>(effect, Effect::EdgeDetection::blurRadius)));
+
+            default:
+                return area;
+            }
+        }
+
+        /**
+         * The area of effect space that might contain non-transparent output from the node
+         */
+        juce::Rectangle<int> getBounds(Node const& node) const
+        {
+            if (!node.effect)
+                return node.image.getBounds();
+
+            if (node.constantColor)
+                return isTransparent(*node.constantColor) ? juce::Rectangle<int>{} : getUnboundedArea();
+
+            auto& effect = *node.effect;
+
+            switch (effect.effectType)
+            {
+            case Effect::Type::flood:
+                return getUnboundedArea();
+
+            case Effect::Type::gaussianBlur:
+            {
+                if (getProperty<int>(effect, Effect::GaussianBlur::borderMode) == Effect::GaussianBlur::hard)
+                    return getInputBounds(node, 0);
+
+                auto radius = BlurKernels::getBlurRadius(getProperty<float>(effect, Effect::GaussianBlur::standardDeviation));
+                return expandBounds(getInputBounds(node, 0), radius);
+            }
+
+            case Effect::Type::shadow:
+            {
+                auto radius = BlurKernels::getBlurRadius(getProperty<float>(effect, Effect::Shadow::blurStandardDeviation));
+                return expandBounds(getInputBounds(node, 0), radius);
+            }
+
+            case Effect::Type::affineTransform2D:
+            {
+                auto inputBounds = getInputBounds(node, 0);
+                auto transform = getTransform(node);
+                if (inputBounds.isEmpty() || transform.isSingularity())
+                    return {};
+
+                if (inputBounds == getUnboundedArea())
+                    return inputBounds;
+
+                //
+                // Soft edges spread as far as the filter reaches past the last source pixel
+                //
+                auto margin = 0;
+                if (getProperty<int>(effect, Effect::AffineTransform2D::borderMode) == Effect::AffineTransform2D::soft)
+                    margin = ResampleKernels::getSourceMargin(transform, getProperty<int>(effect, Effect::AffineTransform2D::interpolationMode));
+
+                return inputBounds.expanded(margin).toFloat().transformedBy(transform).getSmallestIntegerContainer().expanded(1).getIntersection(getUnboundedArea());
+            }
+
+            case Effect::Type::perspectiveTransform3D:
+            {
+                auto inputBounds = getInputBounds(node, 0);
+                auto projection = getPerspectiveProjection(effect);
+                if (inputBounds.isEmpty() || projection.isSingular())
+                    return {};
+
+                if (inputBounds == getUnboundedArea())
+                    return inputBounds;
+
+                auto margin = 0;
+                if (getProperty<int>(effect, Effect::PerspectiveTransform3D::borderMode) == Effect::PerspectiveTransform3D::soft)
+                    margin = ResampleKernels::getPerspectiveMargin(getProperty<int>(effect, Effect::PerspectiveTransform3D::interpolationMode));
+
+                return expandBounds(ResampleKernels::getProjectedBounds(projection, inputBounds.expanded(margin), getUnboundedArea()), 1);
+            }
+
+            case Effect::Type::crop:
+                return getInputBounds(node, 0).getIntersection(getCropRect(effect).getSmallestIntegerContainer());
+
+            case Effect::Type::edgeDetect:
+                return expandBounds(getInputBounds(node, 0), ConvolutionKernels::getEdgeDetectRadius(getProperty<float>(effect, Effect::EdgeDetection::blurRadius)));
+
+            case Effect::Type::alphaMask:
+                return getInputBounds(node, 0).getIntersection(getInputBounds(node, 1));
+
+            case Effect::Type::arithmeticComposite:
+                if (getProperty<Vector4>(effect, Effect::ArithmeticComposite::coefficients)[3] != 0.0f)
+                    return getUnboundedArea();
+                [[fallthrough]];
+
+            case Effect::Type::composite:
+            case Effect::Type::blend:
+            {
+                juce::Rectangle<int> bounds;
+                for (size_t slot = 0; slot < node.inputs.size(); ++slot)
+                    bounds = bounds.getUnion(getInputBounds(node, slot));
+
+                return bounds;
+            }
+
+            default:
+                return getInputBounds(node, 0);
+            }
+        }
+
+        /**
+         * The matrix for an affine transform node, which may have had other transforms merged into it
+         */
+        static juce::AffineTransform getTransform(Node const& node)
+        {
+            if (node.transform)
+                return *node.transform;
+
+            return getProperty<juce::AffineTransform>(*node.effect, Effect::AffineTransform2D::transformMatrix);
+        }
+
+        /**
+         * Effects without a fixed size (such as flood) cover this area
+         */
+        static juce::Rectangle<int> getUnboundedArea() noexcept
+        {
+            constexpr int extent = 1 << 24;
+            return { -extent, -extent, extent * 2, extent * 2 };
+        }
+
+        static juce::Rectangle<int> expandBounds(juce::Rectangle<int> bounds, int amount)
+        {
+            if (bounds.isEmpty() || bounds == getUnboundedArea())
+                return bounds;
+
+            return bounds.expanded(amount).getIntersection(getUnboundedArea());
+        }
+
+        //==============================================================================
+        //
+        // Images and properties
+        //
+
+        static PixelBuffer loadImage(juce::Image const& image, juce::Rectangle<int> area)
+        {
+            auto overlap = area.getIntersection(image.getBounds());
+            if (overlap.isEmpty())
+                return PixelBuffer{ area };
+
+            juce::Image::BitmapData data{ image, overlap.getX(), overlap.getY(), overlap.getWidth(), overlap.getHeight(), juce::Image::BitmapData::readOnly };
+            return loadImage(data, overlap.getPosition(), area);
+        }
+
+        /**
+         * The top-left pixel of data is at origin in effect space
+         */
+        static PixelBuffer loadImage(juce::Image::BitmapData const& data, juce::Point<int> origin, juce::Rectangle<int> area)
+        {
+            PixelBuffer buffer{ area };
+
+            auto overlap = area.getIntersection({ origin.x, origin.y, data.width, data.height });
+            if (overlap.isEmpty())
+                return buffer;
+
+            parallelForRows(overlap.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int row = startRow; row < endRow; ++row)
+                    {
+                        auto y = overlap.getY() + row;
+                        loadRow(data, overlap.getX() - origin.x, y - origin.y, buffer.getRow(y) + (overlap.getX() - area.getX()), overlap.getWidth());
+                    }
+                });
+
+            return buffer;
+        }
+
+        static AlphaBuffer loadImageAlpha(juce::Image const& image, juce::Rectangle<int> area)
+        {
+            auto overlap = area.getIntersection(image.getBounds());
+            if (overlap.isEmpty())
+                return AlphaBuffer{ area };
+
+            juce::Image::BitmapData data{ image, overlap.getX(), overlap.getY(), overlap.getWidth(), overlap.getHeight(), juce::Image::BitmapData::readOnly };
+            return loadImageAlpha(data, overlap.getPosition(), area);
+        }
+
+        static AlphaBuffer loadImageAlpha(juce::Image::BitmapData const& data, juce::Point<int> origin, juce::Rectangle<int> area)
+        {
+            AlphaBuffer buffer{ area };
+
+            auto overlap = area.getIntersection({ origin.x, origin.y, data.width, data.height });
+            if (overlap.isEmpty())
+                return buffer;
+
+            parallelForRows(overlap.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<Color128> row((size_t)overlap.getWidth());
+
+                    for (int y = overlap.getY() + startRow; y < overlap.getY() + endRow; ++y)
+                    {
+                        loadRow(data, overlap.getX() - origin.x, y - origin.y, row.data(), overlap.getWidth());
+                        std::transform(row.begin(), row.end(), buffer.getRow(y) + (overlap.getX() - area.getX()),
+                            [](Color128 pixel) { return pixel.alpha; });
+                    }
+                });
+
+            return buffer;
+        }
+
+        static void writeToImage(PixelBuffer const& output, juce::Image& outputImage, bool clearDestination)
+        {
+            //
+            // output.area is in image coordinates
+            //
+            auto const& area = output.area;
+            juce::Image::BitmapData data{ outputImage, area.getX(), area.getY(), area.getWidth(), area.getHeight(), juce::Image::BitmapData::readWrite };
+            auto width = area.getWidth();
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<Color128> row((size_t)width);
+
+                    for (int y = startRow; y < endRow; ++y)
+                    {
+                        auto source = output.getRow(area.getY() + y);
+                        if (clearDestination)
+                        {
+                            storeRow(data, 0, y, source, width);
+                            continue;
+                        }
+
+                        loadRow(data, 0, y, row.data(), width);
+                        for (int x = 0; x < width; ++x)
+                        {
+                            auto pixel = Vec4::fromColor(source[x]);
+                            row[(size_t)x] = (pixel + Vec4::fromColor(row[(size_t)x]) * (Vec4{ 1.0f } - pixel.broadcast(3))).toColor();
+                        }
+
+                        storeRow(data, 0, y, row.data(), width);
+                    }
+                });
+        }
+
+        static juce::Rectangle<float> getCropRect(Effect& effect)
+        {
+            //
+            // The default crop rectangle is +/- FLT_MAX; keep it within the unbounded area so it converts safely to int
+            //
+            auto rect = getProperty<Vector4>(effect, Effect::Crop::rect);
+            auto limits = getUnboundedArea().toFloat();
+            auto left = juce::jlimit(limits.getX(), limits.getRight(), rect[0]);
+            auto top = juce::jlimit(limits.getY(), limits.getBottom(), rect[1]);
+            auto right = juce::jlimit(left, limits.getRight(), rect[2]);
+            auto bottom = juce::jlimit(top, limits.getBottom(), rect[3]);
+            return juce::Rectangle<float>::leftTopRightBottom(left, top, right, bottom);
+        }
+
+        static ChromaKeyKernels::Key getChromaKey(Effect& effect)
+        {
+            ChromaKeyKernels::Key key;
+            key.color = getProperty<Vector3>(effect, Effect::ChromaKey::color);
+            key.tolerance = getProperty<float>(effect, Effect::ChromaKey::tolerance);
+            key.invertAlpha = getProperty<bool>(effect, Effect::ChromaKey::invertAlpha);
+            key.feather = getProperty<bool>(effect, Effect::ChromaKey::feather);
+            key.metric = getProperty<int>(effect, Effect::ChromaKey::distanceMetric) == Effect::ChromaKey::yCbCr
+                ? ChromaKeyKernels::Metric::yCbCr : ChromaKeyKernels::Metric::rgb;
+            return key;
+        }
+
+        /**
+         * The light position, target, focus and cone angle have the same indices in both spot lighting effects
+         */
+        static LightingKernels::SpotLight getSpotLight(Effect& effect, int colorIndex)
+        {
+            return { getProperty<Vector3>(effect, Effect::SpotDiffuseLighting::lightPosition),
+                getProperty<Vector3>(effect, Effect::SpotDiffuseLighting::pointsAt),
+                getProperty<float>(effect, Effect::SpotDiffuseLighting::focus),
+                getProperty<float>(effect, Effect::SpotDiffuseLighting::limitingConeAngle),
+                getProperty<Vector3>(effect, colorIndex) };
+        }
+
+        static LightingKernels::Surface getSurface(Effect& effect, int surfaceScaleIndex, int kernelUnitLengthIndex)
+        {
+            return { getProperty<float>(effect, surfaceScaleIndex), getProperty<Vector2>(effect, kernelUnitLengthIndex) };
+        }
+
+        static ResampleKernels::Projection getPerspectiveProjection(Effect& effect)
+        {
+            return ResampleKernels::getPerspectiveProjection(getProperty<float>(effect, Effect::PerspectiveTransform3D::depth),
+                getProperty<Vector2>(effect, Effect::PerspectiveTransform3D::perspectiveOrigin),
+                getProperty<Vector3>(effect, Effect::PerspectiveTransform3D::localOffset),
+                getProperty<Vector3>(effect, Effect::PerspectiveTransform3D::globalOffset),
+                getProperty<Vector3>(effect, Effect::PerspectiveTransform3D::rotationOrigin),
+                getProperty<Vector3>(effect, Effect::PerspectiveTransform3D::rotation));
+        }
+
+        static Color128 toColor(Vector4 vector) noexcept
+        {
+            return { vector[0], vector[1], vector[2], vector[3] };
+        }
+
+        /**
+         * Reads a property value, converting between the numeric types that can hold it
+         */
+        template <typename T>
+        static T getProperty(Effect& effect, int index)
+        {
+            auto value = effect.getPropertyValue(index);
+
+            if (auto exactValue = std::get_if<T>(&value))
+                return *exactValue;
+
+            if constexpr (std::is_arithmetic_v<T>)
+            {
+                if (auto enumValue = std::get_if<Enumeration>(&value)) return (T)*enumValue;
+                if (auto intValue = std::get_if<int>(&value)) return (T)*intValue;
+                if (auto uintValue = std::get_if<uint32_t>(&value)) return (T)*uintValue;
+                if (auto floatValue = std::get_if<float>(&value)) return (T)*floatValue;
+                if (auto boolValue = std::get_if<bool>(&value)) return (T)*boolValue;
+            }
+
+            if constexpr (std::is_same_v<T, Vector4>)
+            {
+                if (auto colour = std::get_if<juce::Colour>(&value))
+                    return colourToVector4(*colour);
+            }
+
+            if constexpr (std::is_same_v<T, Vector3>)
+            {
+                if (auto colour = std::get_if<juce::Colour>(&value))
+                    return { colour->getFloatRed(), colour->getFloatGreen(), colour->getFloatBlue() };
+            }
+
+            return T{};
+        }
+    };
+
+} // namespace mescal::software
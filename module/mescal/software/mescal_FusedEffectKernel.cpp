@@ -0,0 +1,206 @@
+namespace mescal::software
+{
+    /*
+
+        Single-pass kernel for chains of point-wise effects
+
+        Point-wise effects (flood, invert, luminance to alpha, alpha mask, arithmetic composite, blend, composite, and
+        chroma key) compute each output pixel from the input pixels at the same position. When several of them feed
+        each other, running them one at a time writes and re-reads a full-size intermediate buffer for every effect
+        in the chain.
+
+        A FusedEffectKernel is a small program that runs the whole chain one row at a time instead. Each register is
+        a single row of pixels; the program loads the rows of the chain's external inputs into registers, then runs
+        each effect in order on those registers. Intermediate results never leave the per-thread row buffers, so the
+        chain costs one read of each external input and one write of the final output.
+
+    */
+    struct FusedEffectKernel
+    {
+        struct Load
+        {
+            PixelBuffer const* source = nullptr; // both nullptr for an unconnected input
+            AlphaBuffer const* alphaSource = nullptr;
+            int target = 0;
+        };
+
+        struct Operation
+        {
+            Effect::Type type = Effect::Type::invert;
+            int target = 0; // holds input 0 before the operation and the result afterwards
+            int other = -1; // holds input 1 for two-input effects
+            int mode = 0;
+            Color128 color{};
+            Vector4 coefficients{};
+            bool clampOutput = true;
+            juce::Rectangle<int> sourceBounds;
+            ChromaKeyKernels::Key chromaKey;
+        };
+
+        int addRegister() noexcept
+        {
+            return numRegisters++;
+        }
+
+        int addLoad(PixelBuffer const* source)
+        {
+            auto target = addRegister();
+            loads.push_back({ source, nullptr, target });
+            return target;
+        }
+
+        /**
+         * Loads an alpha-only input as black pixels with that alpha
+         */
+        int addLoad(AlphaBuffer const& alphaSource)
+        {
+            auto target = addRegister();
+            loads.push_back({ nullptr, &alphaSource, target });
+            return target;
+        }
+
+        void addOperation(Operation const& operation)
+        {
+            operations.push_back(operation);
+        }
+
+        void run(PixelBuffer& destination, int resultRegister) const
+        {
+            auto const& area = destination.area;
+            auto width = area.getWidth();
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<Color128> registers((size_t)numRegisters * (size_t)width);
+                    auto getRegister = [&](int index)
+                        {
+                            return registers.data() + (size_t)index * (size_t)width;
+                        };
+
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        for (auto const& load : loads)
+                            loadRow(load, area.getX(), y, width, getRegister(load.target));
+
+                        for (auto const& operation : operations)
+                            runOperation(operation, area.getX(), y, width, getRegister(operation.target),
+                                operation.other >= 0 ? getRegister(operation.other) : nullptr);
+
+                        std::copy_n(getRegister(resultRegister), width, destination.getRow(y));
+                    }
+                });
+        }
+
+    private:
+        std::vector<Load> loads;
+        std::vector<Operation> operations;
+        int numRegisters = 0;
+
+        /**
+         * Copies one row of an input into a register; pixels outside the input's area are transparent
+         */
+        static void loadRow(Load const& load, int x, int y, int width, Color128* row)
+        {
+            std::fill_n(row, width, Color128{});
+
+            if (load.source)
+                loadRow(*load.source, x, y, width, row, [](Color128 pixel) { return pixel; });
+            else if (load.alphaSource)
+                loadRow(*load.alphaSource, x, y, width, row, [](float alpha) { return Color128{ 0.0f, 0.0f, 0.0f, alpha }; });
+        }
+
+        template <typename Sample, typename Function>
+        static void loadRow(ImageBuffer<Sample> const& source, int x, int y, int width, Color128* row, Function&& toPixel)
+        {
+            if (y < source.area.getY() || y >= source.area.getBottom())
+                return;
+
+            auto start = juce::jmax(x, source.area.getX());
+            auto end = juce::jmin(x + width, source.area.getRight());
+            if (start < end)
+                std::transform(source.getRow(y) + (start - source.area.getX()), source.getRow(y) + (end - source.area.getX()), row + (start - x), toPixel);
+        }
+
+        template <typename Function>
+        static void forEachPixel(Color128* row, int width, Function&& function)
+        {
+            for (int column = 0; column < width; ++column)
+                row[column] = function(Vec4::fromColor(row[column])).toColor();
+        }
+
+        template <typename Function>
+        static void forEachPixelPair(Color128* row, Color128 const* other, int width, Function&& function)
+        {
+            for (int column = 0; column < width; ++column)
+                row[column] = function(Vec4::fromColor(row[column]), Vec4::fromColor(other[column])).toColor();
+        }
+
+        static void runOperation(Operation const& operation, int x, int y, int width, Color128* row, Color128 const* other)
+        {
+            switch (operation.type)
+            {
+            case Effect::Type::flood:
+                std::fill_n(row, width, operation.color);
+                break;
+
+            case Effect::Type::invert:
+                forEachPixel(row, width, EffectKernels::invertPixel);
+                break;
+
+            case Effect::Type::luminanceToAlpha:
+                forEachPixel(row, width, EffectKernels::luminanceToAlphaPixel);
+                break;
+
+            case Effect::Type::alphaMask:
+                forEachPixelPair(row, other, width, EffectKernels::alphaMaskPixel);
+                break;
+
+            case Effect::Type::arithmeticComposite:
+            {
+                EffectKernels::ArithmeticCoefficients const arithmetic{ operation.coefficients, operation.clampOutput };
+                forEachPixelPair(row, other, width, [&](Vec4 source, Vec4 destination)
+                    {
+                        return arithmetic.apply(source, destination);
+                    });
+                break;
+            }
+
+            case Effect::Type::composite:
+            {
+                auto const& bounds = operation.sourceBounds;
+                auto insideRows = y >= bounds.getY() && y < bounds.getBottom();
+                auto start = insideRows ? juce::jlimit(0, width, bounds.getX() - x) : width;
+                auto end = insideRows ? juce::jlimit(start, width, bounds.getRight() - x) : width;
+
+                if (operation.mode == Effect::Composite::boundedSourceCopy)
+                {
+                    std::copy(other + start, other + end, row + start);
+                    break;
+                }
+
+                //
+                // The source is transparent outside its bounds, so those spans skip straight to the mode's shortcut
+                //
+                auto compositeRow = CompositeKernels::getRowFunction(operation.mode);
+                compositeRow(row, nullptr, start);
+                compositeRow(row + start, other + start, end - start);
+                compositeRow(row + end, nullptr, width - end);
+                break;
+            }
+
+            case Effect::Type::blend:
+                BlendKernels::getRowFunction(operation.mode)(row, other, width, x, y);
+                break;
+
+            case Effect::Type::chromaKey:
+                ChromaKeyKernels::chromaKeyRow(row, width, operation.chromaKey);
+                break;
+
+            default:
+                jassertfalse;
+                break;
+            }
+        }
+    };
+
+} // namespace mescal::software
@@ -0,0 +1,231 @@
+namespace mescal::software
+{
+    /*
+
+        Spot lighting kernels for the software renderer
+
+        SpotDiffuseLighting and SpotSpecularLighting follow the SVG lighting filters that Direct2D implements. The
+        input alpha is treated as a height map; a Sobel filter over it gives the surface normal, and a spot light
+        shades the surface.
+
+        Both steps happen in one pass. Each band of rows keeps the three alpha rows the Sobel filter reads in a
+        small rolling buffer, and four pixels are shaded at a time with one pixel in each Vec4 lane, so no normal
+        map is ever written out. The spot light falloff and the specular highlight are powers with exponents of up
+        to 200; both come from lookup tables built once per call instead of calling std::pow for every pixel.
+
+        The kernels only read the input alpha, so the renderer hands them an AlphaBuffer.
+
+    */
+    struct LightingKernels
+    {
+        static constexpr int powerTableSize = 4096;
+
+        struct SpotLight
+        {
+            Vector3 position{};
+            Vector3 pointsAt{};
+            float focus = 1.0f;
+            float limitingConeAngle = 90.0f;
+            Vector3 color{ 1.0f, 1.0f, 1.0f };
+        };
+
+        struct Surface
+        {
+            float surfaceScale = 1.0f;
+            Vector2 kernelUnitLength{ 1.0f, 1.0f };
+        };
+
+        /**
+         * Opaque output; each pixel is the light color times diffuseConstant * (N . L)
+         */
+        static void spotDiffuse(AlphaBuffer const& source, PixelBuffer& destination, SpotLight const& light, Surface const& surface, float diffuseConstant)
+        {
+            shade<false>(source, destination, light, surface, diffuseConstant, 1.0f);
+        }
+
+        /**
+         * Each pixel is the light color times specularConstant * (N . H)^specularExponent, with alpha set to the
+         * brightest channel so the highlight can be composited over the lit image
+         */
+        static void spotSpecular(AlphaBuffer const& source, PixelBuffer& destination, SpotLight const& light, Surface const& surface,
+            float specularConstant, float specularExponent)
+        {
+            shade<true>(source, destination, light, surface, specularConstant, specularExponent);
+        }
+
+    private:
+        /**
+         * x^exponent for x in [0, 1], interpolated from a table; negative x gives 0
+         */
+        struct PowerTable
+        {
+            explicit PowerTable(float exponent)
+            {
+                values.resize(powerTableSize + 2);
+                for (int index = 0; index <= powerTableSize; ++index)
+                    values[(size_t)index] = std::pow((float)index / (float)powerTableSize, exponent);
+
+                values[powerTableSize + 1] = values[powerTableSize];
+            }
+
+            float operator() (float x) const noexcept
+            {
+                if (x <= 0.0f)
+                    return 0.0f;
+
+                auto position = juce::jmin(x, 1.0f) * (float)powerTableSize;
+                auto index = (size_t)position;
+                auto fraction = position - (float)index;
+                return values[index] + (values[index + 1] - values[index]) * fraction;
+            }
+
+            std::vector<float> values;
+        };
+
+        template <bool specular>
+        static void shade(AlphaBuffer const& source, PixelBuffer& destination, SpotLight const& light, Surface const& surface,
+            float constant, float specularExponent)
+        {
+            auto const& area = destination.area;
+            auto width = area.getWidth();
+
+            //
+            // S is the unit vector from the light to the point it's aimed at
+            //
+            auto spotX = light.pointsAt[0] - light.position[0];
+            auto spotY = light.pointsAt[1] - light.position[1];
+            auto spotZ = light.pointsAt[2] - light.position[2];
+            auto spotLength = std::sqrt(spotX * spotX + spotY * spotY + spotZ * spotZ);
+            if (spotLength > 0.0f)
+            {
+                spotX /= spotLength;
+                spotY /= spotLength;
+                spotZ /= spotLength;
+            }
+
+            auto cosConeAngle = std::cos(juce::degreesToRadians(juce::jmin(std::abs(light.limitingConeAngle), 90.0f)));
+            PowerTable const spotPower{ light.focus };
+            PowerTable const specularPower{ specularExponent };
+
+            //
+            // The SVG Sobel kernels scale the gradient by 1/4; a longer kernel unit spans more height per sample
+            //
+            Vec4 const gradientX{ -surface.surfaceScale * 0.25f * surface.kernelUnitLength[0] };
+            Vec4 const gradientY{ -surface.surfaceScale * 0.25f * surface.kernelUnitLength[1] };
+            Vec4 const surfaceScale{ surface.surfaceScale };
+            Vec4 const lightX{ light.position[0] }, lightY{ light.position[1] }, lightZ{ light.position[2] };
+            Vec4 const one{ 1.0f }, two{ 2.0f }, tiny{ 1.0e-12f };
+            Vec4 const laneOffsets{ 0.0f, 1.0f, 2.0f, 3.0f };
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    //
+                    // Alpha for the rows above, at, and below the current row. Line index i holds column
+                    // area.getX() - 1 + i; the padding on the right keeps the last group of four in bounds.
+                    //
+                    auto lineLength = (size_t)(width + 2 + 3);
+                    std::array<std::vector<float>, 3> lines{ std::vector<float>(lineLength), std::vector<float>(lineLength), std::vector<float>(lineLength) };
+
+                    auto fetchLine = [&](std::vector<float>& line, int y)
+                        {
+                            std::fill(line.begin(), line.end(), 0.0f);
+                            if (y < source.area.getY() || y >= source.area.getBottom())
+                                return;
+
+                            auto start = juce::jmax(area.getX() - 1, source.area.getX());
+                            auto end = juce::jmin(area.getRight() + 1, source.area.getRight());
+                            if (start < end)
+                                std::memcpy(line.data() + (start - area.getX() + 1), source.getRow(y) + (start - source.area.getX()), sizeof(float) * (size_t)(end - start));
+                        };
+
+                    auto firstY = area.getY() + startRow;
+                    fetchLine(lines[0], firstY - 1);
+                    fetchLine(lines[1], firstY);
+                    fetchLine(lines[2], firstY + 1);
+
+                    std::array<float, 4> spotLanes, shadeLanes;
+
+                    for (int y = firstY; y < area.getY() + endRow; ++y)
+                    {
+                        if (y > firstY)
+                        {
+                            std::swap(lines[0], lines[1]);
+                            std::swap(lines[1], lines[2]);
+                            fetchLine(lines[2], y + 1);
+                        }
+
+                        auto above = lines[0].data();
+                        auto center = lines[1].data();
+                        auto below = lines[2].data();
+                        auto output = destination.getRow(y);
+                        Vec4 const pixelY{ (float)y + 0.5f };
+
+                        for (int column = 0; column < width; column += 4)
+                        {
+                            auto aboveLeft = Vec4::load(above + column);
+                            auto aboveMiddle = Vec4::load(above + column + 1);
+                            auto aboveRight = Vec4::load(above + column + 2);
+                            auto left = Vec4::load(center + column);
+                            auto middle = Vec4::load(center + column + 1);
+                            auto right = Vec4::load(center + column + 2);
+                            auto belowLeft = Vec4::load(below + column);
+                            auto belowMiddle = Vec4::load(below + column + 1);
+                            auto belowRight = Vec4::load(below + column + 2);
+
+                            //
+                            // Surface normal (normalX, normalY, 1) / normalLength
+                            //
+                            auto normalX = gradientX * ((aboveRight + two * right + belowRight) - (aboveLeft + two * left + belowLeft));
+                            auto normalY = gradientY * ((belowLeft + two * belowMiddle + belowRight) - (aboveLeft + two * aboveMiddle + aboveRight));
+                            auto normalLength = Vec4::sqrt(normalX * normalX + normalY * normalY + one);
+
+                            //
+                            // Unit vector from the surface point to the light
+                            //
+                            auto pixelX = Vec4{ (float)(area.getX() + column) + 0.5f } + laneOffsets;
+                            auto toLightX = lightX - pixelX;
+                            auto toLightY = lightY - pixelY;
+                            auto toLightZ = lightZ - surfaceScale * middle;
+                            auto lightLength = Vec4::max(Vec4::sqrt(toLightX * toLightX + toLightY * toLightY + toLightZ * toLightZ), tiny);
+                            toLightX = toLightX / lightLength;
+                            toLightY = toLightY / lightLength;
+                            toLightZ = toLightZ / lightLength;
+
+                            auto minusLDotS = Vec4{} - (toLightX * Vec4{ spotX } + toLightY * Vec4{ spotY } + toLightZ * Vec4{ spotZ });
+
+                            Vec4 shading;
+                            if constexpr (specular)
+                            {
+                                //
+                                // Halfway vector between the light and the eye at (0, 0, 1)
+                                //
+                                auto halfwayZ = toLightZ + one;
+                                auto halfwayLength = Vec4::max(Vec4::sqrt(toLightX * toLightX + toLightY * toLightY + halfwayZ * halfwayZ), tiny);
+                                shading = (normalX * toLightX + normalY * toLightY + halfwayZ) / (normalLength * halfwayLength);
+                            }
+                            else
+                            {
+                                shading = (normalX * toLightX + normalY * toLightY + toLightZ) / normalLength;
+                            }
+
+                            minusLDotS.store(spotLanes.data());
+                            shading.store(shadeLanes.data());
+
+                            auto numLanes = juce::jmin(4, width - column);
+                            for (int lane = 0; lane < numLanes; ++lane)
+                            {
+                                auto spot = spotLanes[(size_t)lane] < cosConeAngle ? 0.0f : spotPower(spotLanes[(size_t)lane]);
+                                auto intensity = spot * constant * (specular ? specularPower(shadeLanes[(size_t)lane]) : juce::jmax(shadeLanes[(size_t)lane], 0.0f));
+
+                                auto red = juce::jmin(light.color[0] * intensity, 1.0f);
+                                auto green = juce::jmin(light.color[1] * intensity, 1.0f);
+                                auto blue = juce::jmin(light.color[2] * intensity, 1.0f);
+                                output[column + lane] = { red, green, blue, specular ? juce::jmax(red, green, blue) : 1.0f };
+                            }
+                        }
+                    }
+                });
+        }
+    };
+
+} // namespace mescal::software
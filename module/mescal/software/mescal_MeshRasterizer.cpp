@@ -0,0 +1,451 @@
+namespace mescal::software
+{
+    /*
+
+        Software rasterizer for tensor-product Coons patch meshes
+
+        Each patch is a bicubic Bezier surface defined by a 4x4 grid of control points, with a color at each
+        corner. The rasterizer subdivides every patch into a grid of flat quads, splits each quad into two
+        triangles, and fills the triangles with Gouraud shading into a premultiplied floating-point buffer.
+
+        Subdivision is adaptive: the number of steps in u is chosen per mesh column and the number of steps
+        in v per mesh row, using Wang's bound for the control net so that the flat quads never deviate more than
+        flatnessTolerance pixels from the true surface. Patches in the same mesh column share the same u steps,
+        and patches in the same mesh row share the same v steps, so adjacent patches always produce identical
+        vertices along a shared edge and the tessellation has no cracks or T-junctions.
+
+        Colors are bilinear across each patch. Each vertex carries its (u, v) patch coordinates rather than a color;
+        the rasterizer interpolates (u, v) across the triangle and evaluates the bilinear color per pixel, so color
+        accuracy doesn't depend on how finely the patch is subdivided.
+
+        Triangles are filled with a top-left fill rule using edge functions that are evaluated identically on
+        both sides of a shared edge, so every pixel center is covered exactly once. Rendering is split into
+        horizontal bands of scanlines that are processed in parallel; each band draws the triangles in patch
+        order so overlapping patches are painted the same way regardless of thread count.
+
+    */
+    struct MeshRasterizer
+    {
+        /**
+         * A patch ready for rasterization; points are row-major and already transformed into image space.
+         * Colors are in MeshGradient::cornerPlacements order (topLeft, bottomLeft, bottomRight, topRight).
+         */
+        struct Patch
+        {
+            std::array<juce::Point<float>, 16> points;
+            std::array<Color128, 4> colors;
+        };
+
+        struct Vertex
+        {
+            juce::Point<float> position;
+            float u, v;
+        };
+
+        struct Triangle
+        {
+            std::array<uint32_t, 3> vertexIndices;
+            uint32_t patchIndex;
+        };
+
+        /**
+         * Premultiplied corner colors for one patch in bilinear order: top left, top right, bottom left, bottom right
+         */
+        using CornerColors = std::array<Color128, 4>;
+
+        static constexpr float flatnessTolerance = 0.5f;
+        static constexpr int maxSteps = 128;
+        static constexpr int rowsPerBand = 32;
+
+        void tessellate(int numRows, int numColumns, std::vector<Patch> const& patches)
+        {
+            jassert(patches.size() == (size_t)(numRows * numColumns));
+
+            std::vector<int> columnSteps((size_t)numColumns, 1);
+            std::vector<int> rowSteps((size_t)numRows, 1);
+
+            for (int row = 0; row < numRows; ++row)
+            {
+                for (int column = 0; column < numColumns; ++column)
+                {
+                    auto const& patch = patches[(size_t)(row * numColumns + column)];
+                    columnSteps[(size_t)column] = juce::jmax(columnSteps[(size_t)column], getSteps(patch, 1));
+                    rowSteps[(size_t)row] = juce::jmax(rowSteps[(size_t)row], getSteps(patch, 4));
+                }
+            }
+
+            //
+            // Reserve a contiguous range of vertices and triangles for each patch so patches can be tessellated in parallel
+            //
+            struct Range
+            {
+                size_t firstVertex, firstTriangle;
+                int uSteps, vSteps;
+            };
+
+            std::vector<Range> ranges;
+            ranges.reserve(patches.size());
+            size_t numVertices = 0, numTriangles = 0;
+            for (int row = 0; row < numRows; ++row)
+            {
+                for (int column = 0; column < numColumns; ++column)
+                {
+                    auto uSteps = columnSteps[(size_t)column];
+                    auto vSteps = rowSteps[(size_t)row];
+                    ranges.push_back({ numVertices, numTriangles, uSteps, vSteps });
+                    numVertices += (size_t)((uSteps + 1) * (vSteps + 1));
+                    numTriangles += (size_t)(uSteps * vSteps * 2);
+                }
+            }
+
+            vertices.resize(numVertices);
+            triangles.resize(numTriangles);
+            binnedHeight = -1;
+
+            parallelFor((int)patches.size(), [&](int patchIndex)
+                {
+                    auto const& range = ranges[(size_t)patchIndex];
+                    tessellatePatch(patches[(size_t)patchIndex], (uint32_t)patchIndex, range.uSteps, range.vSteps,
+                        vertices.data() + range.firstVertex,
+                        (uint32_t)range.firstVertex,
+                        triangles.data() + range.firstTriangle);
+                });
+
+            setColors(patches);
+        }
+
+        /**
+         * Updates the patch colors without touching the tessellation; colors are evaluated per pixel, so a color change
+         * never requires the patches to be subdivided again
+         */
+        void setColors(std::vector<Patch> const& patches)
+        {
+            patchColors.resize(patches.size());
+
+            auto colorIterator = patchColors.begin();
+            for (auto const& patch : patches)
+            {
+                *colorIterator++ =
+                {
+                    premultiplied(patch.colors[0]),
+                    premultiplied(patch.colors[3]),
+                    premultiplied(patch.colors[1]),
+                    premultiplied(patch.colors[2])
+                };
+            }
+        }
+
+        void render(juce::Image::BitmapData& destination, Color128 backgroundColor)
+        {
+            auto width = destination.width;
+            auto height = destination.height;
+            if (width <= 0 || height <= 0)
+                return;
+
+            if (height != binnedHeight)
+                binTriangles(height);
+
+            parallelFor((int)bands.size(), [&](int band)
+                {
+                    auto startRow = band * rowsPerBand;
+                    auto endRow = juce::jmin(height, startRow + rowsPerBand);
+                    std::vector<Color128> buffer((size_t)(width * (endRow - startRow)), backgroundColor);
+
+                    for (auto triangleIndex : bands[(size_t)band])
+                    {
+                        auto const& triangle = triangles[triangleIndex];
+                        auto const& indices = triangle.vertexIndices;
+                        fillTriangle(vertices[indices[0]], vertices[indices[1]], vertices[indices[2]],
+                            patchColors[triangle.patchIndex],
+                            buffer.data(), width, startRow, endRow);
+                    }
+
+                    for (auto row = startRow; row < endRow; ++row)
+                        storeRow(destination, 0, row, buffer.data() + (size_t)((row - startRow) * width), width);
+                });
+        }
+
+        std::vector<Vertex> vertices;
+        std::vector<Triangle> triangles;
+        std::vector<CornerColors> patchColors;
+
+    private:
+        std::vector<std::vector<uint32_t>> bands;
+        int binnedHeight = -1;
+
+        /**
+         * Sorts the triangles into bands of rows; each band keeps its triangles in drawing order. The bands stay valid
+         * until the patches are tessellated again or the image height changes.
+         */
+        void binTriangles(int height)
+        {
+            auto numBands = (height + rowsPerBand - 1) / rowsPerBand;
+            bands.assign((size_t)numBands, {});
+            for (uint32_t triangleIndex = 0; triangleIndex < (uint32_t)triangles.size(); ++triangleIndex)
+            {
+                auto const& indices = triangles[triangleIndex].vertexIndices;
+                auto top = juce::jmin(vertices[indices[0]].position.y, vertices[indices[1]].position.y, vertices[indices[2]].position.y);
+                auto bottom = juce::jmax(vertices[indices[0]].position.y, vertices[indices[1]].position.y, vertices[indices[2]].position.y);
+                if (!(bottom >= 0.0f && top < (float)height))
+                    continue;
+
+                auto firstBand = juce::jlimit(0, numBands - 1, (int)std::floor(top) / rowsPerBand);
+                auto lastBand = juce::jlimit(0, numBands - 1, (int)std::ceil(bottom) / rowsPerBand);
+                for (auto band = firstBand; band <= lastBand; ++band)
+                    bands[(size_t)band].push_back(triangleIndex);
+            }
+
+            binnedHeight = height;
+        }
+
+        static std::array<float, 4> bernstein(float t) noexcept
+        {
+            auto s = 1.0f - t;
+            return { s * s * s, 3.0f * t * s * s, 3.0f * t * t * s, t * t * t };
+        }
+
+        /**
+         * Wang's bound for the number of flat segments needed along one parametric direction.
+         * stride is 1 to walk along u (across each control point row) and 4 to walk along v (down each column).
+         */
+        static int getSteps(Patch const& patch, size_t stride) noexcept
+        {
+            auto otherStride = stride == 1 ? size_t{ 4 } : size_t{ 1 };
+            float maxSecondDifference = 0.0f;
+
+            for (size_t line = 0; line < 4; ++line)
+            {
+                auto start = line * otherStride;
+                for (size_t k = 0; k < 2; ++k)
+                {
+                    auto p0 = patch.points[start + k * stride];
+                    auto p1 = patch.points[start + (k + 1) * stride];
+                    auto p2 = patch.points[start + (k + 2) * stride];
+                    auto secondDifference = p0 - p1 * 2.0f + p2;
+                    maxSecondDifference = juce::jmax(maxSecondDifference, std::hypot(secondDifference.x, secondDifference.y));
+                }
+            }
+
+            auto steps = std::ceil(std::sqrt(0.75f * maxSecondDifference / flatnessTolerance));
+            return juce::jlimit(1, maxSteps, (int)steps);
+        }
+
+        static void tessellatePatch(Patch const& patch, uint32_t patchIndex, int uSteps, int vSteps, Vertex* destinationVertices, uint32_t firstVertexIndex, Triangle* destinationTriangles)
+        {
+            //
+            // Precompute the u basis once per column; positions are summed row by row in the same order for every patch
+            // so that neighboring patches produce bit-identical points along shared edges
+            //
+            std::vector<std::array<float, 4>> uBasis((size_t)uSteps + 1);
+            for (int i = 0; i <= uSteps; ++i)
+                uBasis[(size_t)i] = bernstein((float)i / (float)uSteps);
+
+            auto vertex = destinationVertices;
+            for (int j = 0; j <= vSteps; ++j)
+            {
+                auto v = (float)j / (float)vSteps;
+                auto vBasis = bernstein(v);
+
+                for (int i = 0; i <= uSteps; ++i)
+                {
+                    auto const& bu = uBasis[(size_t)i];
+                    juce::Point<float> position;
+
+                    for (size_t row = 0; row < 4; ++row)
+                    {
+                        auto const* p = patch.points.data() + row * 4;
+                        juce::Point<float> rowPoint
+                        {
+                            bu[0] * p[0].x + bu[1] * p[1].x + bu[2] * p[2].x + bu[3] * p[3].x,
+                            bu[0] * p[0].y + bu[1] * p[1].y + bu[2] * p[2].y + bu[3] * p[3].y
+                        };
+                        position.x += vBasis[row] * rowPoint.x;
+                        position.y += vBasis[row] * rowPoint.y;
+                    }
+
+                    *vertex++ = { position, (float)i / (float)uSteps, v };
+                }
+            }
+
+            auto rowLength = (uint32_t)uSteps + 1;
+            auto triangle = destinationTriangles;
+            for (uint32_t j = 0; j < (uint32_t)vSteps; ++j)
+            {
+                for (uint32_t i = 0; i < (uint32_t)uSteps; ++i)
+                {
+                    auto a = firstVertexIndex + j * rowLength + i;
+                    auto b = a + 1;
+                    auto c = a + rowLength;
+                    auto d = c + 1;
+                    *triangle++ = { { a, b, d }, patchIndex };
+                    *triangle++ = { { a, d, c }, patchIndex };
+                }
+            }
+        }
+
+        struct EdgeFunction
+        {
+            EdgeFunction(juce::Point<float> from, juce::Point<float> to, float orientation) noexcept
+            {
+                //
+                // Evaluate every edge from its lexicographically smaller endpoint so the two triangles sharing this edge
+                // compute exactly the same value with opposite signs
+                //
+                if (to.x < from.x || (to.x == from.x && to.y < from.y))
+                {
+                    std::swap(from, to);
+                    orientation = -orientation;
+                }
+
+                origin = from;
+                dx = to.x - from.x;
+                dy = to.y - from.y;
+                sign = orientation;
+
+                //
+                // Top-left fill rule for pixels centered exactly on the edge
+                //
+                auto a = -dy * sign;
+                auto b = dx * sign;
+                includeZero = a > 0.0f || (a == 0.0f && b > 0.0f);
+            }
+
+            float evaluate(float x, float y) const noexcept
+            {
+                return sign * (dx * (y - origin.y) - dy * (x - origin.x));
+            }
+
+            float gradientX() const noexcept
+            {
+                return dy * sign;
+            }
+
+            bool inside(float value) const noexcept
+            {
+                return value > 0.0f || (value == 0.0f && includeZero);
+            }
+
+            /**
+             * Conservative horizontal range of pixels on the scanline through y that can be inside this edge
+             */
+            void clipSpan(float y, int& left, int& right) const noexcept
+            {
+                auto a = -dy * sign;
+                if (a == 0.0f)
+                {
+                    if (!inside(evaluate(0.0f, y)))
+                        right = left - 1;
+                    return;
+                }
+
+                //
+                // A nearly horizontal edge can cross this scanline far outside the int range; only the span matters
+                //
+                auto crossing = juce::jlimit((float)left - 1.0f, (float)right + 1.0f, origin.x + dx * (y - origin.y) / dy - 0.5f);
+                if (a > 0.0f)
+                    left = juce::jmax(left, (int)std::floor(crossing));
+                else
+                    right = juce::jmin(right, (int)std::ceil(crossing));
+            }
+
+            juce::Point<float> origin;
+            float dx = 0.0f, dy = 0.0f, sign = 1.0f;
+            bool includeZero = false;
+        };
+
+        static void fillTriangle(Vertex const& v0, Vertex const& v1, Vertex const& v2, CornerColors const& colors, Color128* buffer, int width, int startRow, int endRow) noexcept
+        {
+            auto area = (v1.position.x - v0.position.x) * (v2.position.y - v0.position.y) - (v2.position.x - v0.position.x) * (v1.position.y - v0.position.y);
+            if (area == 0.0f || !std::isfinite(area))
+                return;
+
+            auto orientation = area > 0.0f ? 1.0f : -1.0f;
+            std::array<EdgeFunction, 3> edges
+            {
+                EdgeFunction{ v1.position, v2.position, orientation },
+                EdgeFunction{ v2.position, v0.position, orientation },
+                EdgeFunction{ v0.position, v1.position, orientation }
+            };
+            auto inverseArea = 1.0f / std::abs(area);
+
+            auto top = juce::jmax(startRow, (int)std::floor(juce::jmin(v0.position.y, v1.position.y, v2.position.y) - 0.5f));
+            auto bottom = juce::jmin(endRow - 1, (int)std::ceil(juce::jmax(v0.position.y, v1.position.y, v2.position.y) - 0.5f));
+            auto left = juce::jmax(0, (int)std::floor(juce::jmin(v0.position.x, v1.position.x, v2.position.x) - 0.5f));
+            auto right = juce::jmin(width - 1, (int)std::ceil(juce::jmax(v0.position.x, v1.position.x, v2.position.x) - 0.5f));
+
+            auto const& topLeft = colors[0];
+            auto const& topRight = colors[1];
+            auto const& bottomLeft = colors[2];
+            auto const& bottomRight = colors[3];
+
+            //
+            // (u, v) are linear across the triangle, so step them with their x gradient along each span
+            //
+            auto uGradient = -(edges[0].gradientX() * v0.u + edges[1].gradientX() * v1.u + edges[2].gradientX() * v2.u) * inverseArea;
+            auto vGradient = -(edges[0].gradientX() * v0.v + edges[1].gradientX() * v1.v + edges[2].gradientX() * v2.v) * inverseArea;
+
+            for (auto y = top; y <= bottom; ++y)
+            {
+                auto centerY = (float)y + 0.5f;
+                auto spanLeft = left, spanRight = right;
+                for (auto const& edge : edges)
+                    edge.clipSpan(centerY, spanLeft, spanRight);
+
+                //
+                // The conservative span is at most a pixel or two wider than the exact one at each end; trim it with exact
+                // edge tests so shared edges are resolved identically by both triangles. The triangle is convex, so every
+                // pixel between the trimmed ends is inside.
+                //
+                auto isInside = [&](int x)
+                    {
+                        auto centerX = (float)x + 0.5f;
+                        return edges[0].inside(edges[0].evaluate(centerX, centerY))
+                            && edges[1].inside(edges[1].evaluate(centerX, centerY))
+                            && edges[2].inside(edges[2].evaluate(centerX, centerY));
+                    };
+
+                while (spanLeft <= spanRight && !isInside(spanLeft))
+                    ++spanLeft;
+
+                while (spanRight >= spanLeft && !isInside(spanRight))
+                    --spanRight;
+
+                if (spanLeft > spanRight)
+                    continue;
+
+                auto startX = (float)spanLeft + 0.5f;
+                auto w0 = edges[0].evaluate(startX, centerY) * inverseArea;
+                auto w1 = edges[1].evaluate(startX, centerY) * inverseArea;
+                auto w2 = edges[2].evaluate(startX, centerY) * inverseArea;
+                auto startU = w0 * v0.u + w1 * v1.u + w2 * v2.u;
+                auto startV = w0 * v0.v + w1 * v1.v + w2 * v2.v;
+
+                auto row = buffer + (size_t)((y - startRow) * width);
+                for (auto x = spanLeft; x <= spanRight; ++x)
+                {
+                    auto offset = (float)(x - spanLeft);
+                    auto u = juce::jlimit(0.0f, 1.0f, startU + uGradient * offset);
+                    auto v = juce::jlimit(0.0f, 1.0f, startV + vGradient * offset);
+
+                    auto topLeftWeight = (1.0f - u) * (1.0f - v), topRightWeight = u * (1.0f - v);
+                    auto bottomLeftWeight = (1.0f - u) * v, bottomRightWeight = u * v;
+                    Color128 source
+                    {
+                        topLeftWeight * topLeft.red + topRightWeight * topRight.red + bottomLeftWeight * bottomLeft.red + bottomRightWeight * bottomRight.red,
+                        topLeftWeight * topLeft.green + topRightWeight * topRight.green + bottomLeftWeight * bottomLeft.green + bottomRightWeight * bottomRight.green,
+                        topLeftWeight * topLeft.blue + topRightWeight * topRight.blue + bottomLeftWeight * bottomLeft.blue + bottomRightWeight * bottomRight.blue,
+                        topLeftWeight * topLeft.alpha + topRightWeight * topRight.alpha + bottomLeftWeight * bottomLeft.alpha + bottomRightWeight * bottomRight.alpha
+                    };
+
+                    auto& pixel = row[x];
+                    auto inverseAlpha = 1.0f - source.alpha;
+                    pixel = { source.red + pixel.red * inverseAlpha,
+                        source.green + pixel.green * inverseAlpha,
+                        source.blue + pixel.blue * inverseAlpha,
+                        source.alpha + pixel.alpha * inverseAlpha };
+                }
+            }
+        }
+    };
+
+} // namespace mescal::software
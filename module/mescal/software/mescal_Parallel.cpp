@@ -0,0 +1,112 @@
+namespace mescal::software
+{
+    /*
+
+        Shared worker pool for the software renderers
+
+        parallelFor hands out loop indices one at a time from an atomic counter, so whichever thread
+        is free takes the next item. The calling thread works through the loop as well; that way a
+        parallelFor issued from inside a worker thread still makes progress when every pool thread is busy.
+
+    */
+    struct WorkerPool
+    {
+        juce::ThreadPool pool
+        {
+            juce::ThreadPoolOptions{}
+                .withThreadName("MESCAL worker")
+                .withNumberOfThreads(juce::jmax(1, juce::SystemStats::getNumCpus() - 1))
+        };
+    };
+
+    /**
+     * While one of these is in scope, parallelFor runs every item on the calling thread. Work that's already been
+     * split into pieces for the pool (such as the tiles of a render) uses it so each piece doesn't split itself again.
+     */
+    struct ScopedSerialLoops
+    {
+        ScopedSerialLoops() noexcept : previous(active)
+        {
+            active = true;
+        }
+
+        ~ScopedSerialLoops()
+        {
+            active = previous;
+        }
+
+        static inline thread_local bool active = false;
+        bool const previous;
+    };
+
+    static void parallelFor(int numItems, std::function<void(int)> const& body)
+    {
+        if (numItems <= 0)
+            return;
+
+        if (numItems == 1 || ScopedSerialLoops::active)
+        {
+            for (int item = 0; item < numItems; ++item)
+                body(item);
+
+            return;
+        }
+
+        struct Loop
+        {
+            std::atomic<int> nextItem{ 0 };
+            std::atomic<int> numFinished{ 0 };
+            int numItems = 0;
+            std::function<void(int)> const* body = nullptr;
+            juce::WaitableEvent finished;
+
+            void run()
+            {
+                for (;;)
+                {
+                    auto item = nextItem.fetch_add(1);
+                    if (item >= numItems)
+                        return;
+
+                    (*body)(item);
+
+                    if (numFinished.fetch_add(1) + 1 == numItems)
+                        finished.signal();
+                }
+            }
+        };
+
+        auto loop = std::make_shared<Loop>();
+        loop->numItems = numItems;
+        loop->body = &body;
+
+        juce::SharedResourcePointer<WorkerPool> workers;
+        auto numHelpers = juce::jmin(numItems - 1, workers->pool.getNumThreads());
+        for (int helper = 0; helper < numHelpers; ++helper)
+        {
+            //
+            // Helpers that start after the loop is done see an exhausted counter and return without touching body
+            //
+            workers->pool.addJob([loop] { loop->run(); });
+        }
+
+        loop->run();
+        loop->finished.wait();
+    }
+
+    /**
+     * Splits [0, numRows) into bands of rows and runs each band through parallelFor
+     */
+    static void parallelForRows(int numRows, int rowsPerBand, std::function<void(int, int)> const& body)
+    {
+        rowsPerBand = juce::jmax(1, rowsPerBand);
+        auto numBands = (numRows + rowsPerBand - 1) / rowsPerBand;
+
+        parallelFor(numBands, [&](int band)
+            {
+                auto startRow = band * rowsPerBand;
+                body(startRow, juce::jmin(numRows, startRow + rowsPerBand));
+            });
+    }
+
+} // namespace mescal::software
@@ -0,0 +1,105 @@
+namespace mescal::software
+{
+    /*
+
+        Pixel conversion for the software renderers
+
+        The software renderers work with premultiplied floating-point pixels stored as Color128. These helpers
+        move rows of pixels between that format and the 8-bit JUCE pixel formats.
+
+    */
+
+    static inline uint8_t floatToByte(float value) noexcept
+    {
+        return (uint8_t)(juce::jlimit(0.0f, 1.0f, value) * 255.0f + 0.5f);
+    }
+
+    static inline Color128 premultiplied(Color128 color) noexcept
+    {
+        return { color.red * color.alpha, color.green * color.alpha, color.blue * color.alpha, color.alpha };
+    }
+
+    static inline Color128 premultiplied(juce::Colour colour) noexcept
+    {
+        return premultiplied(Color128{ colour });
+    }
+
+    static void loadRow(juce::Image::BitmapData const& data, int x, int y, Color128* destination, int numPixels)
+    {
+        constexpr float scale = 1.0f / 255.0f;
+        auto source = data.getPixelPointer(x, y);
+
+        switch (data.pixelFormat)
+        {
+        case juce::Image::ARGB:
+            for (int index = 0; index < numPixels; ++index, source += data.pixelStride)
+            {
+                auto pixel = reinterpret_cast<juce::PixelARGB const*>(source);
+                destination[index] = { pixel->getRed() * scale, pixel->getGreen() * scale, pixel->getBlue() * scale, pixel->getAlpha() * scale };
+            }
+            break;
+
+        case juce::Image::RGB:
+            for (int index = 0; index < numPixels; ++index, source += data.pixelStride)
+            {
+                auto pixel = reinterpret_cast<juce::PixelRGB const*>(source);
+                destination[index] = { pixel->getRed() * scale, pixel->getGreen() * scale, pixel->getBlue() * scale, 1.0f };
+            }
+            break;
+
+        case juce::Image::SingleChannel:
+            for (int index = 0; index < numPixels; ++index, source += data.pixelStride)
+            {
+                auto alpha = *source * scale;
+                destination[index] = { alpha, alpha, alpha, alpha };
+            }
+            break;
+
+        default:
+            std::fill(destination, destination + numPixels, Color128{});
+            break;
+        }
+    }
+
+    static void storeRow(juce::Image::BitmapData& data, int x, int y, Color128 const* source, int numPixels)
+    {
+        auto destination = data.getPixelPointer(x, y);
+
+        switch (data.pixelFormat)
+        {
+        case juce::Image::ARGB:
+            for (int index = 0; index < numPixels; ++index, destination += data.pixelStride)
+            {
+                //
+                // Keep the color channels <= alpha so the result is still valid premultiplied data after rounding
+                //
+                auto pixel = Vec4::clamp(Vec4::fromColor(source[index]), 0.0f, 1.0f);
+                pixel = Vec4::min(pixel, pixel.broadcast(3)) * Vec4{ 255.0f } + Vec4{ 0.5f };
+
+                alignas(16) float channels[4];
+                pixel.store(channels);
+                reinterpret_cast<juce::PixelARGB*>(destination)->setARGB((uint8_t)channels[3], (uint8_t)channels[0], (uint8_t)channels[1], (uint8_t)channels[2]);
+            }
+            break;
+
+        case juce::Image::RGB:
+            for (int index = 0; index < numPixels; ++index, destination += data.pixelStride)
+            {
+                auto const& pixel = source[index];
+                reinterpret_cast<juce::PixelRGB*>(destination)->setARGB(255, floatToByte(pixel.red), floatToByte(pixel.green), floatToByte(pixel.blue));
+            }
+            break;
+
+        case juce::Image::SingleChannel:
+            for (int index = 0; index < numPixels; ++index, destination += data.pixelStride)
+            {
+                *destination = floatToByte(source[index].alpha);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+} // namespace mescal::software
@@ -0,0 +1,885 @@
+namespace mescal::software
+{
+    /*
+
+        Resampling kernels for the software AffineTransform2D effect
+
+        Each destination pixel center is mapped back through the inverse transform and the source is filtered around
+        that point. The interpolation modes follow Direct2D:
+
+            nearestNeighbor     the source pixel under the mapped point
+            linear              bilinear interpolation of the nearest 2x2 pixels
+            cubic               4x4 Catmull-Rom cubic
+            highQualityCubic    box-filtered pre-downscale to within 2x of the output size, then a 4x4 cubic; the
+                                sharpness property goes from a smooth Hermite curve (0) to Catmull-Rom (1)
+            multiSampleLinear   the average of four bilinear samples spread over the destination pixel
+            anisotropic         up to maximumAnisotropicSamples bilinear samples along the long axis of the
+                                destination pixel's footprint in the source
+
+        An affine transform scales every pixel by the same amount, so the downscaling modes don't need a whole mip
+        chain. The source is box-filtered once with BlurKernels::downsample, down by the power of two the footprint
+        calls for, and the filter runs on that level instead.
+
+        Three cases skip most of the per-pixel work:
+
+            integer translation     a row copy; every mode reproduces the source exactly, and shadow offsets land here
+            axis-aligned            scales and fractional translations are separable, so the taps for each column are
+                                    worked out once; each row filters the source vertically into a line buffer and
+                                    then filters that horizontally
+            everything else         the mapped point steps incrementally across each row and the channels are
+                                    filtered together in a Vec4
+
+        PerspectiveTransform3D uses the same filters. Its 4x4 matrix is built once and reduced to the 3x3 projection
+        of the z = 0 plane. Across a row the homogeneous source point changes by a constant step, so each pixel costs
+        one reciprocal, and each row only visits the pixels inside the projected outline of the source.
+
+    */
+    struct ResampleKernels
+    {
+        static constexpr int maximumAnisotropicSamples = 16;
+        static constexpr int maximumLevelScale = 64;
+
+        /**
+         * Resamples source into destination, mapping each destination pixel back through the inverse of transform.
+         * The source needs to cover the inverse-mapped destination area expanded by getSourceMargin.
+         *
+         * With hardEdge set, samples are clamped to that rectangle and destination pixels that map outside it are
+         * transparent; otherwise pixels outside the source are transparent and the edges fade out.
+         */
+        template <typename Sample>
+        static void affineTransform(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, juce::AffineTransform const& transform,
+            int interpolationMode, float sharpness, std::optional<juce::Rectangle<int>> hardEdge)
+        {
+            auto sourceArea = hardEdge ? hardEdge->getIntersection(source.area) : source.area;
+            if (transform.isSingularity() || sourceArea.isEmpty())
+            {
+                std::fill(destination.pixels.begin(), destination.pixels.end(), Sample{});
+                return;
+            }
+
+            if (isIntegerTranslation(transform))
+            {
+                translate(source, destination, (int)transform.getTranslationX(), (int)transform.getTranslationY(), sourceArea);
+                return;
+            }
+
+            auto inverse = transform.inverted();
+            auto plan = getPlan(inverse, interpolationMode, sharpness);
+
+            std::optional<juce::Rectangle<float>> edge;
+            if (hardEdge)
+                edge = hardEdge->toFloat();
+
+            if (plan.levelScale == 1)
+            {
+                resample(Sampler<Sample>{ source, sourceArea, hardEdge.has_value() }, destination, inverse, plan, edge);
+                return;
+            }
+
+            //
+            // Level pixel i covers source pixels [i * levelScale, (i + 1) * levelScale), so sampling the level at
+            // (x / levelScale, y / levelScale) samples a box-filtered copy of the source at (x, y)
+            //
+            auto levelScale = plan.levelScale;
+            ImageBuffer<Sample> level{ scaleDown(source.area, levelScale, false) };
+            BlurKernels::downsample(source, level, levelScale);
+
+            auto levelArea = scaleDown(sourceArea, levelScale, hardEdge.has_value());
+            if (edge)
+                edge = juce::Rectangle<float>::leftTopRightBottom(edge->getX() / (float)levelScale, edge->getY() / (float)levelScale,
+                    edge->getRight() / (float)levelScale, edge->getBottom() / (float)levelScale);
+
+            resample(Sampler<Sample>{ level, levelArea, hardEdge.has_value() }, destination, inverse.scaled(1.0f / (float)levelScale), plan, edge);
+        }
+
+        /**
+         * How far outside the inverse-mapped destination area the filter for interpolationMode reads, in source pixels
+         */
+        static int getSourceMargin(juce::AffineTransform const& transform, int interpolationMode)
+        {
+            if (transform.isSingularity())
+                return 0;
+
+            auto inverse = transform.inverted();
+            auto plan = getPlan(inverse, interpolationMode, 1.0f);
+
+            auto reach = 0.0f;
+            for (auto offset : plan.offsets)
+            {
+                auto mapped = mapOffset(inverse, offset);
+                reach = juce::jmax(reach, std::abs(mapped.x), std::abs(mapped.y));
+            }
+
+            return (int)std::ceil(reach) + plan.levelScale * plan.filter.getRadius() + plan.levelScale - 1;
+        }
+
+        static bool isIntegerTranslation(juce::AffineTransform const& transform) noexcept
+        {
+            return transform.isOnlyTranslation()
+                && transform.getTranslationX() == std::floor(transform.getTranslationX())
+                && transform.getTranslationY() == std::floor(transform.getTranslationY());
+        }
+
+        //==============================================================================
+        //
+        // PerspectiveTransform3D
+        //
+
+        /**
+         * A plane-to-plane perspective mapping; the point (x, y) maps to (X / W, Y / W), where
+         * (X, Y, W) = matrix * (x, y, 1) and matrix is stored row by row
+         */
+        struct Projection
+        {
+            std::array<double, 9> matrix{ 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+
+            std::array<double, 3> apply(double x, double y) const noexcept
+            {
+                return { matrix[0] * x + matrix[1] * y + matrix[2],
+                    matrix[3] * x + matrix[4] * y + matrix[5],
+                    matrix[6] * x + matrix[7] * y + matrix[8] };
+            }
+
+            double getDeterminant() const noexcept
+            {
+                auto const& m = matrix;
+                return m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6]) + m[2] * (m[3] * m[7] - m[4] * m[6]);
+            }
+
+            /**
+             * A projection that flattens the plane to a line (such as a card rotated edge-on) has no inverse
+             */
+            bool isSingular() const noexcept
+            {
+                return std::abs(getDeterminant()) < 1.0e-12;
+            }
+
+            Projection inverted() const noexcept
+            {
+                auto const& m = matrix;
+                auto scale = 1.0 / getDeterminant();
+                return { { (m[4] * m[8] - m[5] * m[7]) * scale, (m[2] * m[7] - m[1] * m[8]) * scale, (m[1] * m[5] - m[2] * m[4]) * scale,
+                    (m[5] * m[6] - m[3] * m[8]) * scale, (m[0] * m[8] - m[2] * m[6]) * scale, (m[2] * m[3] - m[0] * m[5]) * scale,
+                    (m[3] * m[7] - m[4] * m[6]) * scale, (m[1] * m[6] - m[0] * m[7]) * scale, (m[0] * m[4] - m[1] * m[3]) * scale } };
+            }
+        };
+
+        /**
+         * Builds the Direct2D 3D perspective transform as a 4x4 matrix and reduces it to the mapping of the z = 0
+         * plane. Points get the local offset, then the rotation (x, then y, then z, in degrees) around the rotation
+         * origin, then the global offset, then the perspective divide around the perspective origin.
+         */
+        static Projection getPerspectiveProjection(float depth, Vector2 perspectiveOrigin, Vector3 localOffset, Vector3 globalOffset,
+            Vector3 rotationOrigin, Vector3 rotation)
+        {
+            using Matrix = std::array<double, 16>;
+
+            auto translation = [](double x, double y, double z) -> Matrix
+                {
+                    return { 1.0, 0.0, 0.0, x, 0.0, 1.0, 0.0, y, 0.0, 0.0, 1.0, z, 0.0, 0.0, 0.0, 1.0 };
+                };
+
+            auto cosX = std::cos(juce::degreesToRadians((double)rotation[0])), sinX = std::sin(juce::degreesToRadians((double)rotation[0]));
+            auto cosY = std::cos(juce::degreesToRadians((double)rotation[1])), sinY = std::sin(juce::degreesToRadians((double)rotation[1]));
+            auto cosZ = std::cos(juce::degreesToRadians((double)rotation[2])), sinZ = std::sin(juce::degreesToRadians((double)rotation[2]));
+            auto perspective = depth > 0.0f ? -1.0 / (double)depth : 0.0;
+
+            std::array<Matrix, 10> const steps
+            {
+                translation(localOffset[0], localOffset[1], localOffset[2]),
+                translation(-rotationOrigin[0], -rotationOrigin[1], -rotationOrigin[2]),
+                Matrix{ 1.0, 0.0, 0.0, 0.0, 0.0, cosX, -sinX, 0.0, 0.0, sinX, cosX, 0.0, 0.0, 0.0, 0.0, 1.0 },
+                Matrix{ cosY, 0.0, sinY, 0.0, 0.0, 1.0, 0.0, 0.0, -sinY, 0.0, cosY, 0.0, 0.0, 0.0, 0.0, 1.0 },
+                Matrix{ cosZ, -sinZ, 0.0, 0.0, sinZ, cosZ, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0 },
+                translation(rotationOrigin[0], rotationOrigin[1], rotationOrigin[2]),
+                translation(globalOffset[0], globalOffset[1], globalOffset[2]),
+                translation(-perspectiveOrigin[0], -perspectiveOrigin[1], 0.0),
+                Matrix{ 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, perspective, 1.0 },
+                translation(perspectiveOrigin[0], perspectiveOrigin[1], 0.0)
+            };
+
+            Matrix matrix = translation(0.0, 0.0, 0.0);
+            for (auto const& step : steps)
+            {
+                Matrix product{};
+                for (size_t row = 0; row < 4; ++row)
+                    for (size_t column = 0; column < 4; ++column)
+                        for (size_t index = 0; index < 4; ++index)
+                            product[row * 4 + column] += step[row * 4 + index] * matrix[index * 4 + column];
+
+                matrix = product;
+            }
+
+            //
+            // Source points have z = 0 and the output z isn't needed, so keep the x, y and w rows and columns
+            //
+            return { { matrix[0], matrix[1], matrix[3], matrix[4], matrix[5], matrix[7], matrix[12], matrix[13], matrix[15] } };
+        }
+
+        /**
+         * The smallest rectangle within limit that holds the projection of area. Any part of area that would land
+         * behind the viewer is cut off first.
+         */
+        static juce::Rectangle<int> getProjectedBounds(Projection const& projection, juce::Rectangle<int> area, juce::Rectangle<int> limit)
+        {
+            auto polygon = getProjectedPolygon(projection, area);
+            if (polygon.empty())
+                return {};
+
+            auto left = (double)limit.getRight(), top = (double)limit.getBottom();
+            auto right = (double)limit.getX(), bottom = (double)limit.getY();
+            for (auto point : polygon)
+            {
+                left = juce::jmin(left, point.x);
+                top = juce::jmin(top, point.y);
+                right = juce::jmax(right, point.x);
+                bottom = juce::jmax(bottom, point.y);
+            }
+
+            return juce::Rectangle<int>::leftTopRightBottom((int)std::floor(juce::jmax(left, (double)limit.getX())),
+                (int)std::floor(juce::jmax(top, (double)limit.getY())),
+                (int)std::ceil(juce::jmin(right, (double)limit.getRight())),
+                (int)std::ceil(juce::jmin(bottom, (double)limit.getBottom()))).getIntersection(limit);
+        }
+
+        /**
+         * How far past the mapped point the filter for a PerspectiveTransform3D interpolation mode reads
+         */
+        static int getPerspectiveMargin(int interpolationMode) noexcept
+        {
+            return getPerspectiveFilter(interpolationMode).getRadius();
+        }
+
+        /**
+         * Maps each destination pixel back through the inverse projection. Only the pixels inside the projected
+         * source are sampled; along each row the homogeneous source point steps by a constant, so each pixel costs
+         * one reciprocal instead of a matrix multiply. Borders work as in affineTransform.
+         *
+         * multiSampleLinear and anisotropic spread their samples using the local scale of the projection at each
+         * pixel, since the footprint changes across the image.
+         */
+        template <typename Sample>
+        static void perspectiveTransform(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, Projection const& projection,
+            int interpolationMode, std::optional<juce::Rectangle<int>> hardEdge)
+        {
+            using Traits = SampleTraits<Sample>;
+            using Value = typename Traits::Value;
+
+            auto const& area = destination.area;
+            auto sourceArea = hardEdge ? hardEdge->getIntersection(source.area) : source.area;
+            std::fill(destination.pixels.begin(), destination.pixels.end(), Sample{});
+            if (sourceArea.isEmpty() || projection.isSingular())
+                return;
+
+            auto filter = getPerspectiveFilter(interpolationMode);
+            auto multiSample = interpolationMode == Effect::PerspectiveTransform3D::multiSampleLinear;
+            auto anisotropic = interpolationMode == Effect::PerspectiveTransform3D::anisotropic;
+            auto clampOutput = filter.kind == Filter::Kind::cubic;
+
+            //
+            // Soft edges fade out over the filter radius past the source, so the covered area reaches that far too
+            //
+            auto polygon = getProjectedPolygon(projection, hardEdge ? *hardEdge : sourceArea.expanded(filter.getRadius()));
+            if (polygon.empty())
+                return;
+
+            std::optional<juce::Rectangle<float>> edge;
+            if (hardEdge)
+                edge = hardEdge->toFloat();
+
+            auto inverse = projection.inverted();
+            auto const& m = inverse.matrix;
+            Sampler<Sample> sampler{ source, sourceArea, hardEdge.has_value() };
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto span = getSpan(polygon, (double)y + 0.5);
+                        if (span.isEmpty())
+                            continue;
+
+                        //
+                        // Pixels whose centers are inside the polygon; the multi-sample modes also reach half a pixel out
+                        //
+                        auto widen = multiSample || anisotropic ? 1 : 0;
+                        auto start = juce::jmax(area.getX(), (int)std::ceil(juce::jmax(span.getStart() - 0.5, (double)area.getX())) - widen);
+                        auto end = juce::jmin(area.getRight(), (int)std::floor(juce::jmin(span.getEnd() - 0.5, (double)area.getRight())) + 1 + widen);
+
+                        auto output = destination.getRow(y) - area.getX();
+                        auto pixelY = (double)y + 0.5;
+                        auto x = m[0] * ((double)start + 0.5) + m[1] * pixelY + m[2];
+                        auto yw = m[3] * ((double)start + 0.5) + m[4] * pixelY + m[5];
+                        auto w = m[6] * ((double)start + 0.5) + m[7] * pixelY + m[8];
+
+                        for (int column = start; column < end; ++column, x += m[0], yw += m[3], w += m[6])
+                        {
+                            if (w <= 0.0)
+                                continue;
+
+                            auto reciprocal = 1.0 / w;
+                            auto sourceX = (float)(x * reciprocal);
+                            auto sourceY = (float)(yw * reciprocal);
+                            if (edge && !edge->contains(juce::Point<float>{ sourceX, sourceY }))
+                                continue;
+
+                            if (!multiSample && !anisotropic)
+                            {
+                                auto value = sampler.sample(filter.getTaps(sourceX), filter.getTaps(sourceY));
+                                output[column] = Traits::store(clampOutput ? clampPremultiplied(value) : value);
+                                continue;
+                            }
+
+                            //
+                            // The source step for one destination pixel along x (stepX) and along y (stepY) at this pixel
+                            //
+                            juce::Point<float> stepX{ (float)((m[0] - (double)sourceX * m[6]) * reciprocal), (float)((m[3] - (double)sourceY * m[6]) * reciprocal) };
+                            juce::Point<float> stepY{ (float)((m[1] - (double)sourceX * m[7]) * reciprocal), (float)((m[4] - (double)sourceY * m[7]) * reciprocal) };
+
+                            Value sum{};
+                            auto numSamples = 4;
+                            if (multiSample)
+                            {
+                                for (auto offset : { juce::Point<float>{ -0.25f, -0.25f }, { 0.25f, -0.25f }, { -0.25f, 0.25f }, { 0.25f, 0.25f } })
+                                {
+                                    auto position = juce::Point<float>{ sourceX, sourceY } + stepX * offset.x + stepY * offset.y;
+                                    sum += sampler.sample(filter.getTaps(position.x), filter.getTaps(position.y));
+                                }
+                            }
+                            else
+                            {
+                                auto lengthX = stepX.getDistanceFromOrigin();
+                                auto lengthY = stepY.getDistanceFromOrigin();
+                                auto major = lengthX >= lengthY ? stepX : stepY;
+                                numSamples = juce::jlimit(1, maximumAnisotropicSamples,
+                                    (int)std::ceil(juce::jmax(lengthX, lengthY) / juce::jmax(juce::jmin(lengthX, lengthY), 1.0f)));
+
+                                for (int index = 0; index < numSamples; ++index)
+                                {
+                                    auto position = juce::Point<float>{ sourceX, sourceY } + major * (((float)index + 0.5f) / (float)numSamples - 0.5f);
+                                    sum += sampler.sample(filter.getTaps(position.x), filter.getTaps(position.y));
+                                }
+                            }
+
+                            output[column] = Traits::store(sum * Traits::splat(1.0f / (float)numSamples));
+                        }
+                    }
+                });
+        }
+
+    private:
+        /**
+         * The source pixels that one output coordinate reads and how much each one contributes
+         */
+        struct Taps
+        {
+            int first = 0;
+            int count = 0;
+            std::array<float, 4> weights{};
+        };
+
+        struct Filter
+        {
+            enum class Kind
+            {
+                nearest,
+                linear,
+                cubic
+            };
+
+            Kind kind = Kind::linear;
+            float a = -0.5f;
+
+            int getRadius() const noexcept
+            {
+                return kind == Kind::cubic ? 2 : 1;
+            }
+
+            /**
+             * Taps for a position in source pixels; pixel i covers [i, i + 1) and its center is at i + 0.5
+             */
+            Taps getTaps(float position) const noexcept
+            {
+                if (kind == Kind::nearest)
+                    return { (int)std::floor(position), 1, { 1.0f } };
+
+                auto shifted = position - 0.5f;
+                auto floor = std::floor(shifted);
+                auto t = shifted - floor;
+
+                if (kind == Kind::linear)
+                    return { (int)floor, 2, { 1.0f - t, t } };
+
+                return { (int)floor - 1, 4, { cubic(1.0f + t), cubic(t), cubic(1.0f - t), cubic(2.0f - t) } };
+            }
+
+            /**
+             * Keys' cubic convolution kernel; a = -0.5 is Catmull-Rom. Every a gives 1 at 0 and 0 at the other
+             * integers, so the kernel passes through the source pixels.
+             */
+            float cubic(float x) const noexcept
+            {
+                if (x < 1.0f)
+                    return ((a + 2.0f) * x - (a + 3.0f)) * x * x + 1.0f;
+
+                return ((a * x - 5.0f * a) * x + 8.0f * a) * x - 4.0f * a;
+            }
+        };
+
+        struct Plan
+        {
+            Filter filter;
+            int levelScale = 1;
+            std::vector<juce::Point<float>> offsets;
+        };
+
+        /**
+         * Picks the filter, the downscaled level, and the sample offsets within each destination pixel
+         * (empty for a single sample at the pixel center)
+         */
+        static Plan getPlan(juce::AffineTransform const& inverse, int interpolationMode, float sharpness)
+        {
+            //
+            // How far apart, in source pixels, neighboring destination pixels are along each destination axis
+            //
+            auto stepX = std::hypot(inverse.mat00, inverse.mat10);
+            auto stepY = std::hypot(inverse.mat01, inverse.mat11);
+
+            Plan plan;
+            switch (interpolationMode)
+            {
+            case Effect::AffineTransform2D::nearestNeighbor:
+                plan.filter.kind = Filter::Kind::nearest;
+                break;
+
+            case Effect::AffineTransform2D::cubic:
+                plan.filter.kind = Filter::Kind::cubic;
+                break;
+
+            case Effect::AffineTransform2D::highQualityCubic:
+                plan.filter = { Filter::Kind::cubic, -0.5f * juce::jlimit(0.0f, 1.0f, sharpness) };
+                plan.levelScale = getLevelScale(juce::jmax(stepX, stepY));
+                break;
+
+            case Effect::AffineTransform2D::multiSampleLinear:
+                plan.levelScale = getLevelScale(juce::jmax(stepX, stepY));
+                plan.offsets = { { -0.25f, -0.25f }, { 0.25f, -0.25f }, { -0.25f, 0.25f }, { 0.25f, 0.25f } };
+                break;
+
+            case Effect::AffineTransform2D::anisotropic:
+            {
+                //
+                // The level is chosen by the short axis of the footprint; the long axis is covered by spreading
+                // samples along it
+                //
+                auto minor = juce::jmin(stepX, stepY);
+                auto major = juce::jmax(stepX, stepY);
+                plan.levelScale = getLevelScale(minor);
+
+                auto levelMinor = juce::jmax(minor / (float)plan.levelScale, 1.0f);
+                auto numSamples = juce::jlimit(1, maximumAnisotropicSamples, (int)std::ceil(major / (float)plan.levelScale / levelMinor));
+                if (numSamples > 1)
+                {
+                    for (int index = 0; index < numSamples; ++index)
+                    {
+                        auto position = ((float)index + 0.5f) / (float)numSamples - 0.5f;
+                        plan.offsets.push_back(stepX >= stepY ? juce::Point<float>{ position, 0.0f } : juce::Point<float>{ 0.0f, position });
+                    }
+                }
+                break;
+            }
+
+            default:
+                break;
+            }
+
+            return plan;
+        }
+
+        /**
+         * The largest power of two no bigger than the footprint, so the footprint on the level is between 1 and 2 pixels
+         */
+        static int getLevelScale(float footprint) noexcept
+        {
+            auto scale = 1;
+            while (scale < maximumLevelScale && (float)(scale * 2) <= footprint)
+                scale *= 2;
+
+            return scale;
+        }
+
+        /**
+         * The level pixels covering area; with inside set, only the level pixels whose whole block is inside area
+         * (if there are any)
+         */
+        static juce::Rectangle<int> scaleDown(juce::Rectangle<int> area, int scale, bool inside) noexcept
+        {
+            auto outer = juce::Rectangle<int>::leftTopRightBottom(BlurKernels::floorDivide(area.getX(), scale),
+                BlurKernels::floorDivide(area.getY(), scale),
+                BlurKernels::floorDivide(area.getRight() - 1, scale) + 1,
+                BlurKernels::floorDivide(area.getBottom() - 1, scale) + 1);
+
+            if (!inside)
+                return outer;
+
+            auto inner = juce::Rectangle<int>::leftTopRightBottom(BlurKernels::floorDivide(area.getX() + scale - 1, scale),
+                BlurKernels::floorDivide(area.getY() + scale - 1, scale),
+                BlurKernels::floorDivide(area.getRight(), scale),
+                BlurKernels::floorDivide(area.getBottom(), scale));
+
+            return inner.getWidth() > 0 && inner.getHeight() > 0 ? inner : outer;
+        }
+
+        static juce::Point<float> mapOffset(juce::AffineTransform const& inverse, juce::Point<float> offset) noexcept
+        {
+            return { inverse.mat00 * offset.x + inverse.mat01 * offset.y, inverse.mat10 * offset.x + inverse.mat11 * offset.y };
+        }
+
+        /**
+         * Reads pixels from one level; outside area, pixels are transparent or clamped to the nearest edge pixel
+         */
+        template <typename Sample>
+        struct Sampler
+        {
+            using Traits = SampleTraits<Sample>;
+            using Value = typename Traits::Value;
+
+            ImageBuffer<Sample> const& buffer;
+            juce::Rectangle<int> area;
+            bool clampToEdge;
+
+            Value fetch(int x, int y) const noexcept
+            {
+                if (clampToEdge)
+                {
+                    x = juce::jlimit(area.getX(), area.getRight() - 1, x);
+                    y = juce::jlimit(area.getY(), area.getBottom() - 1, y);
+                }
+                else if (!area.contains(juce::Point<int>{ x, y }))
+                {
+                    return {};
+                }
+
+                return Traits::load(buffer.getRow(y)[x - buffer.area.getX()]);
+            }
+
+            Value sample(Taps const& column, Taps const& row) const noexcept
+            {
+                Value sum{};
+
+                if (column.first >= area.getX() && column.first + column.count <= area.getRight()
+                    && row.first >= area.getY() && row.first + row.count <= area.getBottom())
+                {
+                    for (int j = 0; j < row.count; ++j)
+                    {
+                        auto pixels = buffer.getRow(row.first + j) + (column.first - buffer.area.getX());
+
+                        Value line{};
+                        for (int i = 0; i < column.count; ++i)
+                            line += Traits::load(pixels[i]) * Traits::splat(column.weights[(size_t)i]);
+
+                        sum += line * Traits::splat(row.weights[(size_t)j]);
+                    }
+
+                    return sum;
+                }
+
+                for (int j = 0; j < row.count; ++j)
+                {
+                    Value line{};
+                    for (int i = 0; i < column.count; ++i)
+                        line += fetch(column.first + i, row.first + j) * Traits::splat(column.weights[(size_t)i]);
+
+                    sum += line * Traits::splat(row.weights[(size_t)j]);
+                }
+
+                return sum;
+            }
+
+            /**
+             * Adds weight times source row y, columns [start, end), to line
+             */
+            void accumulateRow(Value* line, int start, int end, int y, float weight) const noexcept
+            {
+                if (clampToEdge)
+                    y = juce::jlimit(area.getY(), area.getBottom() - 1, y);
+                else if (y < area.getY() || y >= area.getBottom())
+                    return;
+
+                auto pixels = buffer.getRow(y) - buffer.area.getX();
+                auto scale = Traits::splat(weight);
+                auto left = juce::jlimit(start, end, area.getX());
+                auto right = juce::jlimit(start, end, area.getRight());
+
+                if (clampToEdge)
+                {
+                    auto first = Traits::load(pixels[area.getX()]) * scale;
+                    auto last = Traits::load(pixels[area.getRight() - 1]) * scale;
+
+                    for (int x = start; x < left; ++x)
+                        line[x - start] += first;
+                    for (int x = right; x < end; ++x)
+                        line[x - start] += last;
+                }
+
+                for (int x = left; x < right; ++x)
+                    line[x - start] += Traits::load(pixels[x]) * scale;
+            }
+        };
+
+        static Filter getPerspectiveFilter(int interpolationMode) noexcept
+        {
+            switch (interpolationMode)
+            {
+            case Effect::PerspectiveTransform3D::nearestNeighbor: return { Filter::Kind::nearest };
+            case Effect::PerspectiveTransform3D::cubic: return { Filter::Kind::cubic };
+            default: return { Filter::Kind::linear };
+            }
+        }
+
+        /**
+         * The corners of area after projection, with the part behind the viewer (where W would drop to zero or
+         * below) clipped away first; the result is a convex polygon, or empty if all of area is behind the viewer
+         */
+        static std::vector<juce::Point<double>> getProjectedPolygon(Projection const& projection, juce::Rectangle<int> area)
+        {
+            constexpr double minimumW = 1.0e-6;
+
+            std::array<std::array<double, 3>, 4> const corners
+            {
+                projection.apply((double)area.getX(), (double)area.getY()),
+                projection.apply((double)area.getRight(), (double)area.getY()),
+                projection.apply((double)area.getRight(), (double)area.getBottom()),
+                projection.apply((double)area.getX(), (double)area.getBottom())
+            };
+
+            std::vector<juce::Point<double>> polygon;
+            for (size_t index = 0; index < corners.size(); ++index)
+            {
+                auto const& current = corners[index];
+                auto const& next = corners[(index + 1) % corners.size()];
+
+                if (current[2] >= minimumW)
+                    polygon.push_back({ current[0] / current[2], current[1] / current[2] });
+
+                if ((current[2] >= minimumW) != (next[2] >= minimumW))
+                {
+                    auto t = (minimumW - current[2]) / (next[2] - current[2]);
+                    polygon.push_back({ (current[0] + (next[0] - current[0]) * t) / minimumW, (current[1] + (next[1] - current[1]) * t) / minimumW });
+                }
+            }
+
+            return polygon;
+        }
+
+        /**
+         * Where the horizontal line at y crosses a convex polygon
+         */
+        static juce::Range<double> getSpan(std::vector<juce::Point<double>> const& polygon, double y) noexcept
+        {
+            auto left = std::numeric_limits<double>::max();
+            auto right = std::numeric_limits<double>::lowest();
+
+            for (size_t index = 0; index < polygon.size(); ++index)
+            {
+                auto a = polygon[index];
+                auto b = polygon[(index + 1) % polygon.size()];
+                if ((a.y <= y) == (b.y <= y))
+                    continue;
+
+                auto x = a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+                left = juce::jmin(left, x);
+                right = juce::jmax(right, x);
+            }
+
+            if (left > right)
+                return {};
+
+            return { left, right };
+        }
+
+        /**
+         * Cubic kernels overshoot; keep the result a valid premultiplied color
+         */
+        static Vec4 clampPremultiplied(Vec4 value) noexcept
+        {
+            auto alpha = Vec4::clamp(value.broadcast(3), 0.0f, 1.0f);
+            return Vec4::min(Vec4::max(value, Vec4{}), alpha);
+        }
+
+        static float clampPremultiplied(float value) noexcept
+        {
+            return juce::jlimit(0.0f, 1.0f, value);
+        }
+
+        template <typename Sample>
+        static void translate(ImageBuffer<Sample> const& source, ImageBuffer<Sample>& destination, int offsetX, int offsetY, juce::Rectangle<int> sourceArea)
+        {
+            auto const& area = destination.area;
+            auto copyArea = sourceArea.translated(offsetX, offsetY).getIntersection(area);
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto output = destination.getRow(y);
+                        if (copyArea.isEmpty() || y < copyArea.getY() || y >= copyArea.getBottom())
+                        {
+                            std::fill(output, output + area.getWidth(), Sample{});
+                            continue;
+                        }
+
+                        auto start = copyArea.getX() - area.getX();
+                        auto end = copyArea.getRight() - area.getX();
+                        std::fill(output, output + start, Sample{});
+                        std::memcpy(output + start, source.getRow(y - offsetY) + (copyArea.getX() - offsetX - source.area.getX()), sizeof(Sample) * (size_t)(end - start));
+                        std::fill(output + end, output + area.getWidth(), Sample{});
+                    }
+                });
+        }
+
+        template <typename Sample>
+        static void resample(Sampler<Sample> const& sampler, ImageBuffer<Sample>& destination, juce::AffineTransform const& inverse,
+            Plan const& plan, std::optional<juce::Rectangle<float>> edge)
+        {
+            if (inverse.mat01 == 0.0f && inverse.mat10 == 0.0f && plan.offsets.empty())
+            {
+                //
+                // The line buffer holds every source column the row touches; for large downscales most of those
+                // columns aren't used, and sampling each pixel directly does less work
+                //
+                auto columnSpan = std::abs(inverse.mat00) * (float)destination.area.getWidth();
+                if (columnSpan <= (float)(destination.area.getWidth() * plan.filter.getRadius() * 2))
+                {
+                    resampleAxisAligned(sampler, destination, inverse, plan.filter, edge);
+                    return;
+                }
+            }
+
+            resampleGeneral(sampler, destination, inverse, plan, edge);
+        }
+
+        template <typename Sample>
+        static void resampleAxisAligned(Sampler<Sample> const& sampler, ImageBuffer<Sample>& destination, juce::AffineTransform const& inverse,
+            Filter const& filter, std::optional<juce::Rectangle<float>> edge)
+        {
+            using Traits = SampleTraits<Sample>;
+            using Value = typename Traits::Value;
+
+            auto const& area = destination.area;
+            auto clampOutput = filter.kind == Filter::Kind::cubic;
+
+            //
+            // The taps for each column are the same on every row
+            //
+            std::vector<Taps> columns((size_t)area.getWidth());
+            std::vector<uint8_t> columnInside((size_t)area.getWidth(), 1);
+            auto start = std::numeric_limits<int>::max();
+            auto end = std::numeric_limits<int>::min();
+            for (int column = 0; column < area.getWidth(); ++column)
+            {
+                auto sourceX = inverse.mat00 * ((float)(area.getX() + column) + 0.5f) + inverse.mat02;
+                auto& taps = columns[(size_t)column];
+                taps = filter.getTaps(sourceX);
+                start = juce::jmin(start, taps.first);
+                end = juce::jmax(end, taps.first + taps.count);
+
+                if (edge && (sourceX < edge->getX() || sourceX >= edge->getRight()))
+                    columnInside[(size_t)column] = 0;
+            }
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<Value> line((size_t)(end - start));
+
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto output = destination.getRow(y);
+                        auto sourceY = inverse.mat11 * ((float)y + 0.5f) + inverse.mat12;
+                        if (edge && (sourceY < edge->getY() || sourceY >= edge->getBottom()))
+                        {
+                            std::fill(output, output + area.getWidth(), Sample{});
+                            continue;
+                        }
+
+                        std::fill(line.begin(), line.end(), Value{});
+                        auto row = filter.getTaps(sourceY);
+                        for (int j = 0; j < row.count; ++j)
+                            sampler.accumulateRow(line.data(), start, end, row.first + j, row.weights[(size_t)j]);
+
+                        for (int column = 0; column < area.getWidth(); ++column)
+                        {
+                            if (!columnInside[(size_t)column])
+                            {
+                                output[column] = {};
+                                continue;
+                            }
+
+                            auto const& taps = columns[(size_t)column];
+                            auto pixels = line.data() + (taps.first - start);
+
+                            Value sum{};
+                            for (int i = 0; i < taps.count; ++i)
+                                sum += pixels[i] * Traits::splat(taps.weights[(size_t)i]);
+
+                            output[column] = Traits::store(clampOutput ? clampPremultiplied(sum) : sum);
+                        }
+                    }
+                });
+        }
+
+        template <typename Sample>
+        static void resampleGeneral(Sampler<Sample> const& sampler, ImageBuffer<Sample>& destination, juce::AffineTransform const& inverse,
+            Plan const& plan, std::optional<juce::Rectangle<float>> edge)
+        {
+            using Traits = SampleTraits<Sample>;
+            using Value = typename Traits::Value;
+
+            auto const& area = destination.area;
+            auto const& filter = plan.filter;
+            auto clampOutput = filter.kind == Filter::Kind::cubic;
+
+            std::vector<juce::Point<float>> offsets;
+            for (auto offset : plan.offsets)
+                offsets.push_back(mapOffset(inverse, offset));
+
+            auto normalize = Traits::splat(offsets.empty() ? 1.0f : 1.0f / (float)offsets.size());
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto output = destination.getRow(y);
+                        auto pixelY = (float)y + 0.5f;
+                        auto sourceX = inverse.mat00 * ((float)area.getX() + 0.5f) + inverse.mat01 * pixelY + inverse.mat02;
+                        auto sourceY = inverse.mat10 * ((float)area.getX() + 0.5f) + inverse.mat11 * pixelY + inverse.mat12;
+
+                        for (int column = 0; column < area.getWidth(); ++column, sourceX += inverse.mat00, sourceY += inverse.mat10)
+                        {
+                            if (edge && !edge->contains(juce::Point<float>{ sourceX, sourceY }))
+                            {
+                                output[column] = {};
+                                continue;
+                            }
+
+                            Value value{};
+                            if (offsets.empty())
+                            {
+                                value = sampler.sample(filter.getTaps(sourceX), filter.getTaps(sourceY));
+                            }
+                            else
+                            {
+                                for (auto offset : offsets)
+                                    value += sampler.sample(filter.getTaps(sourceX + offset.x), filter.getTaps(sourceY + offset.y));
+
+                                value = value * normalize;
+                            }
+
+                            output[column] = Traits::store(clampOutput ? clampPremultiplied(value) : value);
+                        }
+                    }
+                });
+        }
+    };
+
+} // namespace mescal::software
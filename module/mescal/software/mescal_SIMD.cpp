@@ -0,0 +1,325 @@
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESCAL_SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define MESCAL_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace mescal::software
+{
+    /*
+
+        Four-lane float vector for the software renderers
+
+        Vec4 wraps SSE2 on x86, NEON on ARM, and falls back to plain scalar code elsewhere. The kernels use it two ways:
+        either as four pixels' worth of one quantity (four x coordinates, four angles) or as the RGBA channels of a single
+        premultiplied Color128.
+
+        Only the operations the kernels actually need are here; add more as required.
+
+    */
+    struct alignas(16) Vec4
+    {
+#if MESCAL_SIMD_SSE
+        __m128 v;
+
+        Vec4() noexcept : v(_mm_setzero_ps()) {}
+        Vec4(__m128 v_) noexcept : v(v_) {}
+        explicit Vec4(float value) noexcept : v(_mm_set1_ps(value)) {}
+        Vec4(float a, float b, float c, float d) noexcept : v(_mm_setr_ps(a, b, c, d)) {}
+
+        static Vec4 load(float const* source) noexcept { return _mm_loadu_ps(source); }
+        void store(float* destination) const noexcept { _mm_storeu_ps(destination, v); }
+
+        friend Vec4 operator+ (Vec4 a, Vec4 b) noexcept { return _mm_add_ps(a.v, b.v); }
+        friend Vec4 operator- (Vec4 a, Vec4 b) noexcept { return _mm_sub_ps(a.v, b.v); }
+        friend Vec4 operator* (Vec4 a, Vec4 b) noexcept { return _mm_mul_ps(a.v, b.v); }
+        friend Vec4 operator/ (Vec4 a, Vec4 b) noexcept { return _mm_div_ps(a.v, b.v); }
+
+        static Vec4 min(Vec4 a, Vec4 b) noexcept { return _mm_min_ps(a.v, b.v); }
+        static Vec4 max(Vec4 a, Vec4 b) noexcept { return _mm_max_ps(a.v, b.v); }
+        static Vec4 sqrt(Vec4 a) noexcept { return _mm_sqrt_ps(a.v); }
+        static Vec4 abs(Vec4 a) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+
+        /** Lane mask: all bits set where the comparison is true */
+        static Vec4 lessThan(Vec4 a, Vec4 b) noexcept { return _mm_cmplt_ps(a.v, b.v); }
+
+        /** Picks lanes from ifTrue where mask is set, otherwise from ifFalse */
+        static Vec4 select(Vec4 mask, Vec4 ifTrue, Vec4 ifFalse) noexcept
+        {
+            return _mm_or_ps(_mm_and_ps(mask.v, ifTrue.v), _mm_andnot_ps(mask.v, ifFalse.v));
+        }
+
+        /** True if every lane of the mask is set */
+        static bool allTrue(Vec4 mask) noexcept { return _mm_movemask_ps(mask.v) == 0xf; }
+
+        /** Copies the sign bit of sign onto magnitude */
+        static Vec4 copySign(Vec4 magnitude, Vec4 sign) noexcept
+        {
+            auto signBit = _mm_set1_ps(-0.0f);
+            return _mm_or_ps(_mm_andnot_ps(signBit, magnitude.v), _mm_and_ps(signBit, sign.v));
+        }
+
+        Vec4 broadcast(int lane) const noexcept
+        {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, v);
+            return Vec4{ lanes[lane] };
+        }
+
+        /** (a0, b0, a1, b1) */
+        static Vec4 interleaveLow(Vec4 a, Vec4 b) noexcept { return _mm_unpacklo_ps(a.v, b.v); }
+
+        /** (a2, b2, a3, b3) */
+        static Vec4 interleaveHigh(Vec4 a, Vec4 b) noexcept { return _mm_unpackhi_ps(a.v, b.v); }
+
+#elif MESCAL_SIMD_NEON
+        float32x4_t v;
+
+        Vec4() noexcept : v(vdupq_n_f32(0.0f)) {}
+        Vec4(float32x4_t v_) noexcept : v(v_) {}
+        explicit Vec4(float value) noexcept : v(vdupq_n_f32(value)) {}
+        Vec4(float a, float b, float c, float d) noexcept
+        {
+            alignas(16) float lanes[4]{ a, b, c, d };
+            v = vld1q_f32(lanes);
+        }
+
+        static Vec4 load(float const* source) noexcept { return vld1q_f32(source); }
+        void store(float* destination) const noexcept { vst1q_f32(destination, v); }
+
+        friend Vec4 operator+ (Vec4 a, Vec4 b) noexcept { return vaddq_f32(a.v, b.v); }
+        friend Vec4 operator- (Vec4 a, Vec4 b) noexcept { return vsubq_f32(a.v, b.v); }
+        friend Vec4 operator* (Vec4 a, Vec4 b) noexcept { return vmulq_f32(a.v, b.v); }
+        friend Vec4 operator/ (Vec4 a, Vec4 b) noexcept
+        {
+            auto reciprocal = vrecpeq_f32(b.v);
+            reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(b.v, reciprocal));
+            reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(b.v, reciprocal));
+            return vmulq_f32(a.v, reciprocal);
+        }
+
+        static Vec4 min(Vec4 a, Vec4 b) noexcept { return vminq_f32(a.v, b.v); }
+        static Vec4 max(Vec4 a, Vec4 b) noexcept { return vmaxq_f32(a.v, b.v); }
+        static Vec4 sqrt(Vec4 a) noexcept
+        {
+            auto safe = vmaxq_f32(a.v, vdupq_n_f32(1.0e-30f));
+            auto reciprocalRoot = vrsqrteq_f32(safe);
+            reciprocalRoot = vmulq_f32(reciprocalRoot, vrsqrtsq_f32(vmulq_f32(safe, reciprocalRoot), reciprocalRoot));
+            reciprocalRoot = vmulq_f32(reciprocalRoot, vrsqrtsq_f32(vmulq_f32(safe, reciprocalRoot), reciprocalRoot));
+            return vmulq_f32(a.v, reciprocalRoot);
+        }
+        static Vec4 abs(Vec4 a) noexcept { return vabsq_f32(a.v); }
+
+        static Vec4 lessThan(Vec4 a, Vec4 b) noexcept { return vreinterpretq_f32_u32(vcltq_f32(a.v, b.v)); }
+
+        static Vec4 select(Vec4 mask, Vec4 ifTrue, Vec4 ifFalse) noexcept
+        {
+            return vbslq_f32(vreinterpretq_u32_f32(mask.v), ifTrue.v, ifFalse.v);
+        }
+
+        static bool allTrue(Vec4 mask) noexcept
+        {
+            auto bits = vreinterpretq_u32_f32(mask.v);
+            auto halves = vand_u32(vget_low_u32(bits), vget_high_u32(bits));
+            return (vget_lane_u32(halves, 0) & vget_lane_u32(halves, 1)) == 0xffffffffu;
+        }
+
+        static Vec4 copySign(Vec4 magnitude, Vec4 sign) noexcept
+        {
+            return vbslq_f32(vdupq_n_u32(0x80000000u), sign.v, magnitude.v);
+        }
+
+        Vec4 broadcast(int lane) const noexcept
+        {
+            alignas(16) float lanes[4];
+            vst1q_f32(lanes, v);
+            return Vec4{ lanes[lane] };
+        }
+
+        static Vec4 interleaveLow(Vec4 a, Vec4 b) noexcept { return vzipq_f32(a.v, b.v).val[0]; }
+        static Vec4 interleaveHigh(Vec4 a, Vec4 b) noexcept { return vzipq_f32(a.v, b.v).val[1]; }
+
+#else
+        std::array<float, 4> v{};
+
+        Vec4() noexcept {}
+        explicit Vec4(float value) noexcept : v{ value, value, value, value } {}
+        Vec4(float a, float b, float c, float d) noexcept : v{ a, b, c, d } {}
+
+        static Vec4 load(float const* source) noexcept { return { source[0], source[1], source[2], source[3] }; }
+        void store(float* destination) const noexcept { std::copy(v.begin(), v.end(), destination); }
+
+        template <typename Function>
+        static Vec4 map(Vec4 a, Vec4 b, Function&& function) noexcept
+        {
+            return { function(a.v[0], b.v[0]), function(a.v[1], b.v[1]), function(a.v[2], b.v[2]), function(a.v[3], b.v[3]) };
+        }
+
+        friend Vec4 operator+ (Vec4 a, Vec4 b) noexcept { return map(a, b, [](float x, float y) { return x + y; }); }
+        friend Vec4 operator- (Vec4 a, Vec4 b) noexcept { return map(a, b, [](float x, float y) { return x - y; }); }
+        friend Vec4 operator* (Vec4 a, Vec4 b) noexcept { return map(a, b, [](float x, float y) { return x * y; }); }
+        friend Vec4 operator/ (Vec4 a, Vec4 b) noexcept { return map(a, b, [](float x, float y) { return x / y; }); }
+
+        static Vec4 min(Vec4 a, Vec4 b) noexcept { return map(a, b, [](float x, float y) { return y < x ? y : x; }); }
+        static Vec4 max(Vec4 a, Vec4 b) noexcept { return map(a, b, [](float x, float y) { return x < y ? y : x; }); }
+        static Vec4 sqrt(Vec4 a) noexcept { return map(a, a, [](float x, float) { return std::sqrt(x); }); }
+        static Vec4 abs(Vec4 a) noexcept { return map(a, a, [](float x, float) { return std::abs(x); }); }
+
+        static Vec4 lessThan(Vec4 a, Vec4 b) noexcept
+        {
+            return map(a, b, [](float x, float y) { return x < y ? 1.0f : 0.0f; });
+        }
+
+        static Vec4 select(Vec4 mask, Vec4 ifTrue, Vec4 ifFalse) noexcept
+        {
+            return { mask.v[0] != 0.0f ? ifTrue.v[0] : ifFalse.v[0],
+                mask.v[1] != 0.0f ? ifTrue.v[1] : ifFalse.v[1],
+                mask.v[2] != 0.0f ? ifTrue.v[2] : ifFalse.v[2],
+                mask.v[3] != 0.0f ? ifTrue.v[3] : ifFalse.v[3] };
+        }
+
+        static bool allTrue(Vec4 mask) noexcept
+        {
+            return mask.v[0] != 0.0f && mask.v[1] != 0.0f && mask.v[2] != 0.0f && mask.v[3] != 0.0f;
+        }
+
+        static Vec4 copySign(Vec4 magnitude, Vec4 sign) noexcept
+        {
+            return map(magnitude, sign, [](float x, float y) { return std::copysign(x, y); });
+        }
+
+        Vec4 broadcast(int lane) const noexcept
+        {
+            return Vec4{ v[(size_t)lane] };
+        }
+
+        static Vec4 interleaveLow(Vec4 a, Vec4 b) noexcept { return { a.v[0], b.v[0], a.v[1], b.v[1] }; }
+        static Vec4 interleaveHigh(Vec4 a, Vec4 b) noexcept { return { a.v[2], b.v[2], a.v[3], b.v[3] }; }
+#endif
+
+        Vec4 operator+= (Vec4 other) noexcept { return *this = *this + other; }
+        Vec4 operator*= (Vec4 other) noexcept { return *this = *this * other; }
+
+        static Vec4 clamp(Vec4 a, float lower, float upper) noexcept
+        {
+            return min(max(a, Vec4{ lower }), Vec4{ upper });
+        }
+
+        /** a + (b - a) * t */
+        static Vec4 lerp(Vec4 a, Vec4 b, Vec4 t) noexcept
+        {
+            return a + (b - a) * t;
+        }
+
+        /**
+         * Swaps rows and columns of the 4x4 matrix with rows a, b, c, d; turns four RGBA pixels into one vector per
+         * channel and back again
+         */
+        static void transpose(Vec4& a, Vec4& b, Vec4& c, Vec4& d) noexcept
+        {
+            auto ac0 = interleaveLow(a, c), bd0 = interleaveLow(b, d);
+            auto ac1 = interleaveHigh(a, c), bd1 = interleaveHigh(b, d);
+            a = interleaveLow(ac0, bd0);
+            b = interleaveHigh(ac0, bd0);
+            c = interleaveLow(ac1, bd1);
+            d = interleaveHigh(ac1, bd1);
+        }
+
+        static Vec4 fromColor(Color128 const& color) noexcept
+        {
+            return load(&color.red);
+        }
+
+        Color128 toColor() const noexcept
+        {
+            Color128 color;
+            store(&color.red);
+            return color;
+        }
+    };
+
+    static_assert(sizeof(Color128) == sizeof(float) * 4, "Vec4::fromColor assumes Color128 is four packed floats");
+
+    /**
+     * Four-lane atan2 with a maximum error of about 1e-5 radians
+     *
+     * Reduces the argument to [0, 1] by swapping x and y where |y| > |x|, evaluates a minimax polynomial for atan
+     * on that range, then undoes the reduction and restores the quadrant.
+     */
+    static inline Vec4 atan2(Vec4 y, Vec4 x) noexcept
+    {
+        auto absX = Vec4::abs(x);
+        auto absY = Vec4::abs(y);
+        auto swapped = Vec4::lessThan(absX, absY);
+        auto numerator = Vec4::min(absX, absY);
+        auto denominator = Vec4::max(Vec4::max(absX, absY), Vec4{ 1.0e-30f });
+        auto z = numerator / denominator;
+        auto z2 = z * z;
+
+        auto polynomial = Vec4{ -0.01172120f };
+        polynomial = polynomial * z2 + Vec4{ 0.05265332f };
+        polynomial = polynomial * z2 + Vec4{ -0.11643287f };
+        polynomial = polynomial * z2 + Vec4{ 0.19354346f };
+        polynomial = polynomial * z2 + Vec4{ -0.33262347f };
+        polynomial = polynomial * z2 + Vec4{ 0.99997726f };
+        auto angle = polynomial * z;
+
+        angle = Vec4::select(swapped, Vec4{ juce::MathConstants<float>::halfPi } - angle, angle);
+        angle = Vec4::select(Vec4::lessThan(x, Vec4{ 0.0f }), Vec4{ juce::MathConstants<float>::pi } - angle, angle);
+        return Vec4::copySign(angle, y);
+    }
+
+    /**
+     * The six coefficients of an AffineTransform, each broadcast across all four lanes
+     */
+    struct AffineTransformVec4
+    {
+        AffineTransformVec4(juce::AffineTransform const& transform) noexcept :
+            mat00(transform.mat00), mat01(transform.mat01), mat02(transform.mat02),
+            mat10(transform.mat10), mat11(transform.mat11), mat12(transform.mat12)
+        {
+        }
+
+        void apply(Vec4& x, Vec4& y) const noexcept
+        {
+            auto transformedX = mat00 * x + mat01 * y + mat02;
+            y = mat10 * x + mat11 * y + mat12;
+            x = transformedX;
+        }
+
+        Vec4 mat00, mat01, mat02, mat10, mat11, mat12;
+    };
+
+    /**
+     * Applies an affine transform to separate arrays of x and y coordinates, eight points per iteration. The source and
+     * destination may be the same arrays.
+     */
+    static void transformPoints(juce::AffineTransform const& transform, float const* sourceX, float const* sourceY, float* destinationX, float* destinationY, size_t numPoints) noexcept
+    {
+        AffineTransformVec4 const coefficients{ transform };
+
+        size_t index = 0;
+        for (; index + 8 <= numPoints; index += 8)
+        {
+            auto x0 = Vec4::load(sourceX + index), x1 = Vec4::load(sourceX + index + 4);
+            auto y0 = Vec4::load(sourceY + index), y1 = Vec4::load(sourceY + index + 4);
+            coefficients.apply(x0, y0);
+            coefficients.apply(x1, y1);
+            x0.store(destinationX + index);
+            x1.store(destinationX + index + 4);
+            y0.store(destinationY + index);
+            y1.store(destinationY + index + 4);
+        }
+
+        for (; index < numPoints; ++index)
+        {
+            auto x = sourceX[index];
+            auto y = sourceY[index];
+            destinationX[index] = transform.mat00 * x + transform.mat01 * y + transform.mat02;
+            destinationY[index] = transform.mat10 * x + transform.mat11 * y + transform.mat12;
+        }
+    }
+
+} // namespace mescal::software
@@ -0,0 +1,338 @@
+namespace mescal::software
+{
+    /*
+
+        Tone adjustment kernels for the software effect renderer
+
+        Highlights and shadows brightens or darkens each pixel according to the luminance of its neighborhood rather
+        than its own luminance, so a dark detail inside a bright area is treated as part of the highlights. The local
+        luminance comes from a guided filter (He, Sun & Tang) with the luminance as its own guide. It smooths within
+        regions but stops at strong edges, so there's no halo around the outline of a bright object the way there
+        would be with a plain blur.
+
+        The guided filter is made of box means, and every box mean is a running sum: a horizontal pass over each row
+        and a vertical pass that slides a row of column sums down each strip of columns. The cost per pixel doesn't
+        depend on the radius, and both passes run on the shared worker pool.
+
+        Box means are weighted by alpha. Transparent pixels, including everything outside the input, don't pull the
+        local luminance of nearby opaque pixels down, so the edges of an image aren't mistaken for shadows.
+
+    */
+    struct ToneKernels
+    {
+        static constexpr int columnsPerStrip = 64;
+
+        /**
+         * MaskBlurRadius is in DIPs; Direct2D doesn't say how it maps to the mask, so the box radius is
+         * maskBlurRadius * maskRadiusScale pixels
+         */
+        static constexpr float maskRadiusScale = 8.0f;
+
+        /**
+         * Luminance variance below this is smoothed over; above it, edges are kept
+         */
+        static constexpr float maskEdgeThreshold = 0.01f;
+
+        static int getMaskRadius(float maskBlurRadius) noexcept
+        {
+            return juce::jmax(1, juce::roundToInt(maskBlurRadius * maskRadiusScale));
+        }
+
+        /**
+         * How far outside the output the input is read; each of the two box stages reaches one mask radius
+         */
+        static int getHighlightsAndShadowsMargin(float maskBlurRadius) noexcept
+        {
+            return getMaskRadius(maskBlurRadius) * 2;
+        }
+
+        /**
+         * Tone adjustment in sRGB space with L as the local luminance and Y as the pixel luminance:
+         *
+         *      Y' = Y ^ (2 ^ -(shadows * (1 - L)^2 + highlights * L^2)) + clarity * (Y - L)
+         *
+         * Positive shadows brighten dark areas and negative highlights darken bright areas; clarity scales the
+         * detail relative to the local luminance. The color is scaled by Y' / Y so hue and saturation are kept.
+         * Linear input is converted to sRGB for the adjustment and back again afterwards.
+         *
+         * source must cover destination.area expanded by getHighlightsAndShadowsMargin(maskBlurRadius).
+         */
+        static void highlightsAndShadows(PixelBuffer const& source, PixelBuffer& destination, float highlights, float shadows, float clarity,
+            int inputGamma, float maskBlurRadius)
+        {
+            auto const& area = destination.area;
+            auto radius = getMaskRadius(maskBlurRadius);
+            auto linear = inputGamma == Effect::HighlightsAndShadows::linear;
+
+            //
+            // Straight sRGB colors for the whole input, plus its luminance and alpha for the guided filter
+            //
+            PixelBuffer straight{ source.area };
+            AlphaBuffer luminance{ source.area }, alpha{ source.area };
+            parallelForRows(source.area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    auto width = (size_t)source.area.getWidth();
+                    for (auto index = (size_t)startRow * width, end = (size_t)endRow * width; index < end; ++index)
+                    {
+                        auto pixel = source.pixels[index];
+                        alpha.pixels[index] = pixel.alpha;
+                        if (pixel.alpha <= 0.0f)
+                            continue;
+
+                        Color128 color{ pixel.red / pixel.alpha, pixel.green / pixel.alpha, pixel.blue / pixel.alpha, pixel.alpha };
+                        if (linear)
+                            color = { linearToSRGB(color.red), linearToSRGB(color.green), linearToSRGB(color.blue), color.alpha };
+
+                        straight.pixels[index] = color;
+                        luminance.pixels[index] = getLuminance(color);
+                    }
+                });
+
+            AlphaBuffer localLuminance{ area };
+            guidedFilter(luminance, alpha, localLuminance, radius, maskEdgeThreshold);
+
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto input = straight.getRow(y) + (area.getX() - source.area.getX());
+                        auto local = localLuminance.getRow(y);
+                        auto output = destination.getRow(y);
+
+                        for (int column = 0; column < area.getWidth(); ++column)
+                        {
+                            auto color = input[column];
+                            if (color.alpha <= 0.0f)
+                            {
+                                output[column] = {};
+                                continue;
+                            }
+
+                            auto pixelLuminance = getLuminance(color);
+                            auto neighborhood = juce::jlimit(0.0f, 1.0f, local[column]);
+                            auto shade = 1.0f - neighborhood;
+                            auto exponent = std::exp2(-(shadows * shade * shade + highlights * neighborhood * neighborhood));
+                            auto adjusted = std::pow(juce::jlimit(0.0f, 1.0f, pixelLuminance), exponent) + clarity * (pixelLuminance - neighborhood);
+                            adjusted = juce::jlimit(0.0f, 1.0f, adjusted);
+
+                            //
+                            // Near black there's no color to scale, so the change is added to every channel instead
+                            //
+                            auto red = color.red, green = color.green, blue = color.blue;
+                            if (pixelLuminance > 1.0e-4f)
+                            {
+                                auto gain = adjusted / pixelLuminance;
+                                red *= gain;
+                                green *= gain;
+                                blue *= gain;
+                            }
+                            else
+                            {
+                                auto offset = adjusted - pixelLuminance;
+                                red += offset;
+                                green += offset;
+                                blue += offset;
+                            }
+
+                            red = juce::jlimit(0.0f, 1.0f, red);
+                            green = juce::jlimit(0.0f, 1.0f, green);
+                            blue = juce::jlimit(0.0f, 1.0f, blue);
+                            if (linear)
+                            {
+                                red = sRGBToLinear(red);
+                                green = sRGBToLinear(green);
+                                blue = sRGBToLinear(blue);
+                            }
+
+                            output[column] = { red * color.alpha, green * color.alpha, blue * color.alpha, color.alpha };
+                        }
+                    }
+                });
+        }
+
+        /**
+         * Edge-preserving smoothing of guide by itself; weights scales each pixel's contribution to the box means.
+         * Larger epsilon smooths over stronger edges.
+         *
+         * guide and weights must cover the same area, at least destination.area expanded by radius * 2.
+         */
+        static void guidedFilter(AlphaBuffer const& guide, AlphaBuffer const& weights, AlphaBuffer& destination, int radius, float epsilon)
+        {
+            jassert(guide.area == weights.area && guide.area.contains(destination.area.expanded(radius * 2)));
+
+            //
+            // First stage: a linear model output = a * guide + b fitted to each window
+            //
+            auto modelArea = destination.area.expanded(radius);
+            AlphaBuffer weightedGuide{ guide.area }, weightedSquare{ guide.area };
+            parallelForRows(guide.area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    auto width = (size_t)guide.area.getWidth();
+                    for (auto index = (size_t)startRow * width, end = (size_t)endRow * width; index < end; ++index)
+                    {
+                        auto value = guide.pixels[index];
+                        weightedGuide.pixels[index] = weights.pixels[index] * value;
+                        weightedSquare.pixels[index] = weights.pixels[index] * value * value;
+                    }
+                });
+
+            AlphaBuffer weightSum{ modelArea }, guideSum{ modelArea }, squareSum{ modelArea };
+            boxSum(weights, weightSum, radius);
+            boxSum(weightedGuide, guideSum, radius);
+            boxSum(weightedSquare, squareSum, radius);
+
+            //
+            // Reuse the sums for the weighted slope and offset of each window's model
+            //
+            auto& weightedSlope = guideSum;
+            auto& weightedOffset = squareSum;
+            parallelForRows(modelArea.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    auto width = (size_t)modelArea.getWidth();
+                    for (auto index = (size_t)startRow * width, end = (size_t)endRow * width; index < end; ++index)
+                    {
+                        auto totalWeight = weightSum.pixels[index];
+                        if (totalWeight <= 1.0e-6f)
+                        {
+                            weightedSlope.pixels[index] = 0.0f;
+                            weightedOffset.pixels[index] = 0.0f;
+                            weightSum.pixels[index] = 0.0f;
+                            continue;
+                        }
+
+                        auto mean = guideSum.pixels[index] / totalWeight;
+                        auto variance = juce::jmax(squareSum.pixels[index] / totalWeight - mean * mean, 0.0f);
+                        auto slope = variance / (variance + epsilon);
+
+                        //
+                        // Windows count in proportion to the weight of the pixels they cover
+                        //
+                        auto windowWeight = totalWeight / (float)((radius * 2 + 1) * (radius * 2 + 1));
+                        weightedSlope.pixels[index] = slope * windowWeight;
+                        weightedOffset.pixels[index] = (mean - slope * mean) * windowWeight;
+                        weightSum.pixels[index] = windowWeight;
+                    }
+                });
+
+            //
+            // Second stage: average the models of every window covering each pixel
+            //
+            AlphaBuffer slopeSum{ destination.area }, offsetSum{ destination.area }, windowWeightSum{ destination.area };
+            boxSum(weightedSlope, slopeSum, radius);
+            boxSum(weightedOffset, offsetSum, radius);
+            boxSum(weightSum, windowWeightSum, radius);
+
+            auto const& area = destination.area;
+            parallelForRows(area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    for (int y = area.getY() + startRow; y < area.getY() + endRow; ++y)
+                    {
+                        auto output = destination.getRow(y);
+                        auto slopes = slopeSum.getRow(y);
+                        auto offsets = offsetSum.getRow(y);
+                        auto totals = windowWeightSum.getRow(y);
+                        auto guideRow = guide.getRow(y) + (area.getX() - guide.area.getX());
+
+                        for (int column = 0; column < area.getWidth(); ++column)
+                        {
+                            auto value = guideRow[column];
+                            output[column] = totals[column] > 1.0e-6f ? (slopes[column] * value + offsets[column]) / totals[column] : value;
+                        }
+                    }
+                });
+        }
+
+        static float getLuminance(Color128 const& color) noexcept
+        {
+            return 0.2125f * color.red + 0.7154f * color.green + 0.0721f * color.blue;
+        }
+
+        static float linearToSRGB(float value) noexcept
+        {
+            return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        }
+
+        static float sRGBToLinear(float value) noexcept
+        {
+            return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+    private:
+        /**
+         * Sum of the source over the (radius * 2 + 1) square centered on each destination pixel; source pixels
+         * outside the source area count as zero
+         */
+        static void boxSum(AlphaBuffer const& source, AlphaBuffer& destination, int radius)
+        {
+            auto const& area = destination.area;
+            auto width = area.getWidth();
+
+            //
+            // Horizontal pass from a prefix sum of each row; doubles keep the differences exact on wide rows
+            //
+            AlphaBuffer rowSums{ area.expanded(0, radius) };
+            parallelForRows(rowSums.area.getHeight(), EffectKernels::rowsPerBand, [&](int startRow, int endRow)
+                {
+                    std::vector<double> prefix((size_t)(width + radius * 2 + 1));
+                    for (int y = rowSums.area.getY() + startRow; y < rowSums.area.getY() + endRow; ++y)
+                    {
+                        auto output = rowSums.getRow(y);
+                        if (y < source.area.getY() || y >= source.area.getBottom())
+                        {
+                            std::fill_n(output, width, 0.0f);
+                            continue;
+                        }
+
+                        auto input = source.getRow(y);
+                        auto startX = area.getX() - radius;
+                        auto total = 0.0;
+                        for (int index = 0; index < width + radius * 2; ++index)
+                        {
+                            auto x = startX + index;
+                            if (x >= source.area.getX() && x < source.area.getRight())
+                                total += input[x - source.area.getX()];
+
+                            prefix[(size_t)index + 1] = total;
+                        }
+
+                        for (int column = 0; column < width; ++column)
+                            output[column] = (float)(prefix[(size_t)(column + radius * 2 + 1)] - prefix[(size_t)column]);
+                    }
+                });
+
+            //
+            // Vertical pass sliding a row of column sums down each strip
+            //
+            auto numStrips = (width + columnsPerStrip - 1) / columnsPerStrip;
+            parallelFor(numStrips, [&](int strip)
+                {
+                    auto firstColumn = strip * columnsPerStrip;
+                    auto numColumns = juce::jmin(columnsPerStrip, width - firstColumn);
+                    std::array<double, columnsPerStrip> sums{};
+
+                    for (int y = area.getY() - radius; y < area.getY() + radius; ++y)
+                    {
+                        auto row = rowSums.getRow(y) + firstColumn;
+                        for (int column = 0; column < numColumns; ++column)
+                            sums[(size_t)column] += row[column];
+                    }
+
+                    for (int y = area.getY(); y < area.getBottom(); ++y)
+                    {
+                        auto entering = rowSums.getRow(y + radius) + firstColumn;
+                        auto output = destination.getRow(y) + firstColumn;
+                        for (int column = 0; column < numColumns; ++column)
+                        {
+                            sums[(size_t)column] += entering[column];
+                            output[column] = (float)sums[(size_t)column];
+                        }
+
+                        auto leaving = rowSums.getRow(y - radius) + firstColumn;
+                        for (int column = 0; column < numColumns; ++column)
+                            sums[(size_t)column] -= leaving[column];
+                    }
+                });
+        }
+    };
+
+} // namespace mescal::software